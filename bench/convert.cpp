@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+
+namespace
+{
+// The conversion used before std::from_chars, kept as the baseline.
+template <typename T>
+bool stream_apply_to(T *target, const std::string &value)
+{
+    if (value.find(' ') != std::string::npos)
+    {
+        return false;
+    }
+    std::istringstream iss(value);
+    iss >> *target;
+    return iss.eof() && !iss.fail();
+}
+template <typename T>
+bool stream_apply_to(std::vector<T> *target, const std::string &value)
+{
+    target->clear();
+    if (value.empty())
+    {
+        return true;
+    }
+    std::istringstream iss(value);
+    std::string token;
+    while (!iss.eof())
+    {
+        std::getline(iss, token, ',');
+        T tmp;
+        if (!stream_apply_to<T>(&tmp, token))
+        {
+            return false;
+        }
+        target->emplace_back(std::move(tmp));
+    }
+    return true;
+}
+
+template <typename T>
+struct Input;
+template <>
+struct Input<int64_t>
+{
+    constexpr static const char *value = "-9223372036854775807";
+};
+template <>
+struct Input<uint64_t>
+{
+    constexpr static const char *value = "18446744073709551615";
+};
+template <>
+struct Input<double>
+{
+    constexpr static const char *value = "-31415.9265358979e-4";
+};
+using Int64List = std::vector<int64_t>;
+template <>
+struct Input<Int64List>
+{
+    constexpr static const char *value =
+        "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16";
+};
+}  // namespace
+
+template <typename T>
+static void BM_Stream(benchmark::State &state)
+{
+    std::string value(Input<T>::value);
+    T target{};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(stream_apply_to(&target, value));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+template <typename T>
+static void BM_ApplyTo(benchmark::State &state)
+{
+    std::string value(Input<T>::value);
+    T target{};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            argparse::convert::apply_to<T>(&target, value));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+
+BENCHMARK_TEMPLATE(BM_Stream, int64_t);
+BENCHMARK_TEMPLATE(BM_ApplyTo, int64_t);
+BENCHMARK_TEMPLATE(BM_Stream, uint64_t);
+BENCHMARK_TEMPLATE(BM_ApplyTo, uint64_t);
+BENCHMARK_TEMPLATE(BM_Stream, double);
+BENCHMARK_TEMPLATE(BM_ApplyTo, double);
+BENCHMARK_TEMPLATE(BM_Stream, Int64List);
+BENCHMARK_TEMPLATE(BM_ApplyTo, Int64List);
+
+// Concurrent conversions used to serialize on the global locale.
+BENCHMARK_TEMPLATE(BM_Stream, int64_t)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_ApplyTo, int64_t)->ThreadRange(1, 8);
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+
+namespace
+{
+std::vector<std::string> make_names(size_t nr)
+{
+    std::vector<std::string> names;
+    names.reserve(nr);
+    for (size_t i = 0; i < nr; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    return names;
+}
+argparser::flag::FlagStore::Pointer make_store(
+    const std::vector<std::string> &names)
+{
+    auto store = argparser::flag::FlagStore::new_instance();
+    for (const auto &name : names)
+    {
+        store->add_flag(name, "", "", std::nullopt, false);
+    }
+    return store;
+}
+}  // namespace
+
+// The cost of a lookup should not depend on the number of flags registered.
+static void BM_FlagStoreContain(benchmark::State &state)
+{
+    auto names = make_names(state.range(0));
+    auto store = make_store(names);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store->contain(names[i]));
+        i = (i + 1) % names.size();
+    }
+}
+BENCHMARK(BM_FlagStoreContain)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_FlagStoreContainMiss(benchmark::State &state)
+{
+    auto names = make_names(state.range(0));
+    auto store = make_store(names);
+    std::string miss = "--not-a-registered-flag";
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store->contain(miss));
+    }
+}
+BENCHMARK(BM_FlagStoreContainMiss)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_FlagStoreGet(benchmark::State &state)
+{
+    auto names = make_names(state.range(0));
+    auto store = make_store(names);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&store->get(names[i]));
+        i = (i + 1) % names.size();
+    }
+}
+BENCHMARK(BM_FlagStoreGet)->RangeMultiplier(10)->Range(10, 100000);
+
+// Repeated reads of a stored flag hit the typed cache.
+static void BM_AllocatedFlagTo(benchmark::State &state)
+{
+    auto store = argparser::flag::FlagStore::new_instance();
+    store->add_flag("--batch", "-b", "", std::string("128"), false);
+    const auto &flag = store->get("--batch");
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(flag.to<int>());
+    }
+}
+BENCHMARK(BM_AllocatedFlagTo);
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+
+// A help message over @state.range(0) commands, each with a long description.
+static void BM_HelpCommands(benchmark::State &state)
+{
+    auto parser = argparser::new_parser("A large command tree");
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        names.push_back("command-" + std::to_string(i));
+    }
+    for (const auto &name : names)
+    {
+        auto &command = parser->command(name, argparser::long_sentence);
+        command.flag("--threads", "-T", "The number of threads");
+        command.flag("--time", "-t", "The duration (second) to run");
+    }
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto help = parser->help();
+        bytes += help.size();
+        benchmark::DoNotOptimize(help.data());
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_HelpCommands)->RangeMultiplier(10)->Range(10, 100000);
+
+// A help message over @state.range(0) flags, each with a long description.
+static void BM_HelpFlags(benchmark::State &state)
+{
+    auto parser = argparser::new_parser("A lot of flags");
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    for (const auto &name : names)
+    {
+        parser->flag(name.c_str(), "", argparser::very_long_sentence, "");
+    }
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        auto help = parser->help();
+        bytes += help.size();
+        benchmark::DoNotOptimize(help.data());
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_HelpFlags)->RangeMultiplier(10)->Range(10, 10000);
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+
+namespace
+{
+/**
+ * An argv of @nr_flags "--flag-i value" pairs, after the program name.
+ * The strings are kept in @storage.
+ */
+std::vector<const char *> make_argv(size_t nr_flags,
+                                    std::vector<std::string> &storage)
+{
+    storage.clear();
+    storage.reserve(nr_flags);
+    for (size_t i = 0; i < nr_flags; ++i)
+    {
+        storage.push_back("--flag-" + std::to_string(i));
+    }
+    std::vector<const char *> argv{"./bench"};
+    argv.reserve(1 + nr_flags * 2);
+    for (const auto &name : storage)
+    {
+        argv.push_back(name.c_str());
+        argv.push_back("42");
+    }
+    return argv;
+}
+}  // namespace
+
+// Tokenize an argv of @state.range(0) arguments.
+static void BM_Tokenize(benchmark::State &state)
+{
+    std::vector<std::string> storage;
+    auto argv = make_argv(state.range(0) / 2, storage);
+    for (auto _ : state)
+    {
+        auto tokens = argparser::tokenize(argv.size(), argv.data());
+        benchmark::DoNotOptimize(tokens.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (argv.size() - 1));
+}
+BENCHMARK(BM_Tokenize)->RangeMultiplier(10)->Range(1, 1000000);
+
+// Dispatch every token of a parse to one of @state.range(0) flags.
+static void BM_FlagStoreApply(benchmark::State &state)
+{
+    std::vector<std::string> storage;
+    auto argv = make_argv(state.range(0), storage);
+    auto tokens = argparser::tokenize(argv.size(), argv.data());
+    argparser::flag::FlagStore store;
+    for (const auto &name : storage)
+    {
+        store.add_flag(name, "", "", std::nullopt, false);
+    }
+    for (auto _ : state)
+    {
+        for (const auto &[key, value] : tokens)
+        {
+            benchmark::DoNotOptimize(store.apply(key, value));
+        }
+        store.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+BENCHMARK(BM_FlagStoreApply)->RangeMultiplier(10)->Range(10, 100000);
+
+namespace
+{
+/**
+ * A chain of @depth nested commands, each with one flag, and the argv
+ * reaching the deepest one.
+ */
+std::shared_ptr<argparser::Parser> make_chain(size_t depth,
+                                              std::vector<std::string> &storage)
+{
+    storage.clear();
+    for (size_t i = 0; i < depth; ++i)
+    {
+        storage.push_back("command-" + std::to_string(i));
+    }
+    auto parser = argparser::new_parser();
+    parser->flag("--level", "-l", "", "0");
+    argparser::Parser *current = parser.get();
+    for (const auto &name : storage)
+    {
+        current = &current->command(name);
+        current->flag("--level", "-l", "", "0");
+    }
+    return parser;
+}
+std::vector<const char *> chain_argv(const std::vector<std::string> &storage)
+{
+    std::vector<const char *> argv{"./bench"};
+    for (const auto &name : storage)
+    {
+        argv.push_back(name.c_str());
+    }
+    argv.push_back("--level");
+    argv.push_back("1");
+    return argv;
+}
+}  // namespace
+
+// Parse through @state.range(0) levels of commands.
+static void BM_ParseCommandDepth(benchmark::State &state)
+{
+    std::vector<std::string> storage;
+    auto parser = make_chain(state.range(0), storage);
+    auto argv = chain_argv(storage);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parser->parse(argv.size(), argv.data()));
+    }
+}
+BENCHMARK(BM_ParseCommandDepth)->RangeMultiplier(4)->Range(1, 256);
+
+static void BM_FrozenParseCommandDepth(benchmark::State &state)
+{
+    std::vector<std::string> storage;
+    auto frozen = make_chain(state.range(0), storage)->freeze();
+    auto argv = chain_argv(storage);
+    argparser::ParseResult result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            frozen.parse(argv.size(), argv.data(), result));
+    }
+}
+BENCHMARK(BM_FrozenParseCommandDepth)->RangeMultiplier(4)->Range(1, 256);
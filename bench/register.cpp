@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+
+namespace
+{
+std::vector<std::string> make_names(size_t nr)
+{
+    std::vector<std::string> names;
+    names.reserve(nr);
+    for (size_t i = 0; i < nr; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    return names;
+}
+}  // namespace
+
+// Register @state.range(0) stored flags on a fresh parser.
+static void BM_RegisterAllocatedFlags(benchmark::State &state)
+{
+    auto names = make_names(state.range(0));
+    for (auto _ : state)
+    {
+        auto parser = argparser::new_parser();
+        for (const auto &name : names)
+        {
+            parser->flag(name.c_str(), "", "", "0");
+        }
+        benchmark::DoNotOptimize(parser.get());
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_RegisterAllocatedFlags)->RangeMultiplier(10)->Range(10, 100000);
+
+// Register @state.range(0) typed flags on a fresh parser.
+static void BM_RegisterTypedFlags(benchmark::State &state)
+{
+    auto names = make_names(state.range(0));
+    std::vector<int64_t> slots(names.size());
+    for (auto _ : state)
+    {
+        auto parser = argparser::new_parser();
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            parser->flag(&slots[i], names[i].c_str(), "", "", "0");
+        }
+        benchmark::DoNotOptimize(parser.get());
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_RegisterTypedFlags)->RangeMultiplier(10)->Range(10, 100000);
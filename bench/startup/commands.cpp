@@ -0,0 +1,16 @@
+#include "argparser/argparser.hpp"
+#include "commands.hpp"
+#include "probe.hpp"
+
+// examples/commands.cpp, stopping after parse()
+int main(int argc, const char *argv[])
+{
+    startup::probe("main");
+    auto &parser = argparser::init("lots of commands");
+    register_arg(parser);
+    startup::probe("registered");
+
+    bool succ = parser.parse(argc, argv);
+    startup::probe("parsed");
+    return succ ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Fork and exec an instrumented binary (see probe.hpp) many times, and
+ * report the latency from exec to the end of parse(), split into phases:
+ *   exec:        fork, exec and dynamic loading, up to the first
+ *                constructor of the binary
+ *   static-init: the static initializers of the binary, up to main()
+ *   register:    from main() to the end of registration
+ *   parse:    parse()
+ *
+ * Usage: argparser-startup [-n runs] binary [args...]
+ */
+namespace
+{
+int64_t now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+struct Run
+{
+    int64_t exec{0};
+    int64_t static_init{0};
+    int64_t reg{0};
+    int64_t parse{0};
+    int64_t total{0};
+};
+
+bool run_once(char *const argv[], Run *run)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return false;
+    }
+    int64_t start = now();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        setenv("ARGPARSER_PROBE_FD", std::to_string(fds[1]).c_str(), 1);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    close(fds[1]);
+    std::string output;
+    char buf[256];
+    ssize_t len;
+    while ((len = read(fds[0], buf, sizeof(buf))) > 0)
+    {
+        output.append(buf, len);
+    }
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "Failed to run " << argv[0] << ": exit status " << status
+                  << std::endl;
+        return false;
+    }
+
+    std::map<std::string, int64_t> phases;
+    std::istringstream iss(output);
+    std::string phase;
+    int64_t ts;
+    while (iss >> phase >> ts)
+    {
+        phases[phase] = ts;
+    }
+    for (const char *expect : {"ctor", "main", "registered", "parsed"})
+    {
+        if (phases.count(expect) == 0)
+        {
+            std::cerr << "Failed to run " << argv[0] << ": probe \"" << expect
+                      << "\" not reported" << std::endl;
+            return false;
+        }
+    }
+    run->exec = phases["ctor"] - start;
+    run->static_init = phases["main"] - phases["ctor"];
+    run->reg = phases["registered"] - phases["main"];
+    run->parse = phases["parsed"] - phases["registered"];
+    run->total = phases["parsed"] - start;
+    return true;
+}
+
+double percentile(std::vector<int64_t> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(p * (values.size() - 1));
+    return values[idx] / 1000.0;
+}
+void report(const char *phase, const std::vector<int64_t> &values)
+{
+    printf("%-12s %12.1f %12.1f %12.1f\n",
+           phase,
+           percentile(values, 0.5),
+           percentile(values, 0.99),
+           percentile(values, 1));
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    int runs = 1000;
+    int opt = 1;
+    if (argc > 2 && strcmp(argv[1], "-n") == 0)
+    {
+        runs = atoi(argv[2]);
+        opt = 3;
+    }
+    if (opt >= argc || runs <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [-n runs] binary [args...]"
+                  << std::endl;
+        return 1;
+    }
+    char *const *child_argv = argv + opt;
+
+    std::vector<int64_t> exec, static_init, reg, parse, total;
+    for (int i = 0; i < runs; ++i)
+    {
+        Run run;
+        if (!run_once(child_argv, &run))
+        {
+            return 1;
+        }
+        exec.push_back(run.exec);
+        static_init.push_back(run.static_init);
+        reg.push_back(run.reg);
+        parse.push_back(run.parse);
+        total.push_back(run.total);
+    }
+
+    printf("%s: %d runs, latency in us\n", child_argv[0], runs);
+    printf("%-12s %12s %12s %12s\n", "phase", "p50", "p99", "max");
+    report("exec", exec);
+    report("static-init", static_init);
+    report("register", reg);
+    report("parse", parse);
+    report("total", total);
+    return 0;
+}
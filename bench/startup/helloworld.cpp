@@ -0,0 +1,28 @@
+#include <iostream>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+#include "probe.hpp"
+
+// examples/helloworld.cpp, stopping after parse()
+int main(int argc, const char *argv[])
+{
+    startup::probe("main");
+    auto &parser = argparser::init("A Hello-world Command-line Tool");
+
+    std::vector<int> array;
+    int size;
+
+    parser.flag(&array, "--array", "-A", "An array of int as input", "1,2,3");
+    parser.flag(&size, "--size", "-S", "The size of items", "0");
+
+    int time;
+    auto &run_parser =
+        parser.command("run", "A sub-command, used to run something");
+    run_parser.flag(&time, "--time", "-T", "The time to run", "5");
+    startup::probe("registered");
+
+    bool succ = parser.parse(argc, argv);
+    startup::probe("parsed");
+    return succ ? 0 : 1;
+}
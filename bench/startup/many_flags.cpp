@@ -0,0 +1,21 @@
+#include <string>
+
+#include "argparser/argparser.hpp"
+#include "probe.hpp"
+
+// A synthetic tool with 10k flags. Building the names counts as registration.
+int main(int argc, const char *argv[])
+{
+    startup::probe("main");
+    auto &parser = argparser::init("A tool with a lot of flags");
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto name = "--flag-" + std::to_string(i);
+        parser.flag(name.c_str(), "", "", "0");
+    }
+    startup::probe("registered");
+
+    bool succ = parser.parse(argc, argv);
+    startup::probe("parsed");
+    return succ ? 0 : 1;
+}
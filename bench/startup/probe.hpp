@@ -0,0 +1,55 @@
+#ifndef ARG_PARSER_BENCH_STARTUP_PROBE_H
+#define ARG_PARSER_BENCH_STARTUP_PROBE_H
+
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace startup
+{
+/**
+ * Report that the process reached @phase.
+ *
+ * The driver passes a pipe in $ARGPARSER_PROBE_FD; each probe writes one line
+ * "<phase> <CLOCK_MONOTONIC in ns>" to it. Without the variable, a probe does
+ * nothing, so the binaries also run on their own.
+ */
+inline void probe(const char *phase)
+{
+    static int fd = []() {
+        const char *env = getenv("ARGPARSER_PROBE_FD");
+        return env == nullptr ? -1 : atoi(env);
+    }();
+    if (fd < 0)
+    {
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    char line[64];
+    int len = snprintf(line,
+                       sizeof(line),
+                       "%s %lld\n",
+                       phase,
+                       ts.tv_sec * 1000000000ll + ts.tv_nsec);
+    if (write(fd, line, len) != len)
+    {
+        fd = -1;
+    }
+}
+
+/**
+ * The first constructor of the binary, before the static initializers of
+ * its translation units, which run at the default priority. The time from
+ * here to main() is the static initialization of the binary; the time
+ * before it is fork, exec and dynamic loading.
+ */
+__attribute__((constructor(101))) inline void probe_ctor()
+{
+    probe("ctor");
+}
+}  // namespace startup
+
+#endif
@@ -32,11 +32,21 @@ std::optional<Bar> argparse::convert::try_to<Bar>(const std::string &input)
     return std::nullopt;
 }
 
+enum class Color
+{
+    kRed,
+    kBlue,
+};
+// an enum only needs the names of its values
+ARGPARSER_ENUM(Color, {"red", Color::kRed}, {"blue", Color::kBlue});
+
 int main(int argc, const char *argv[])
 {
     auto &parser = argparser::init("An example of custom convertor");
 
     parser.flag("--bar", "-b", "A custom class Bar");
+    Color color;
+    parser.flag(&color, "--color", "-c", "A color", "red");
 
     bool succ = parser.parse(argc, argv);
     if (!succ)
@@ -48,6 +58,8 @@ int main(int argc, const char *argv[])
     auto& store = parser.store();
     auto bar = store.get("--bar").to<Bar>();
     bar.hello();
+    std::cout << "The color is "
+              << (color == Color::kRed ? "red" : "blue") << std::endl;
 
     return 0;
 }
\ No newline at end of file
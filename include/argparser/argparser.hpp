@@ -3,22 +3,24 @@
 
 #include <string>
 
+#include "./frozen-parser.hpp"
 #include "./parser.hpp"
+#include "./schema.hpp"
 #include "./convert.hpp"
 
 namespace argparser
 {
-const char* one_sentence = "Hello, here is some text without a meaning.";
-const char* very_short_sentence =
+inline const char* one_sentence = "Hello, here is some text without a meaning.";
+inline const char* very_short_sentence =
     "Hello, here is some text without a meaning. This text should "
     "show what aprinted text will look like at this place.";
-const char* short_sentence =
+inline const char* short_sentence =
     "Hello, here is some text without a meaning. This text should "
     "show what aprinted text will look like at this place. If you read this "
     "text, you will get noinformation. Really? Is there no information? Is "
     "there a difference between thistext and some nonsense like “Huardest "
     "gefburn”? Kjift – not at all!";
-const char* long_sentence =
+inline const char* long_sentence =
     "Hello, here is some text without a meaning. This text should "
     "show what aprinted text will look like at this place. If you read this "
     "text, you will get noinformation. Really? Is there no information? Is "
@@ -29,7 +31,7 @@ const char* long_sentence =
     "alphabet and it should be written in of the original language. There is "
     "noneed for special content, but the length of words should match the "
     "language.";
-const char* very_long_sentence =
+inline const char* very_long_sentence =
     "Hello, here is some text without a meaning. This text should "
     "show what aprinted text will look like at this place. If you read this "
     "text, you will get noinformation. Really? Is there no information? Is "
@@ -0,0 +1,228 @@
+#ifndef ARG_PARSER_BITSET_H
+#define ARG_PARSER_BITSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace argparser
+{
+namespace flag
+{
+/**
+ * A growable set of bits, one per flag, stored as 64-bit words.
+ *
+ * The first word is held inline, so a set of up to 64 bits never
+ * allocates. The comparisons between two sets are one masked compare per
+ * word. A word missing from the shorter set reads as zero.
+ */
+class Bitset
+{
+public:
+    using Word = uint64_t;
+    constexpr static size_t kWordBits = 64;
+
+    explicit Bitset(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : rest_(mr)
+    {
+    }
+
+    void set(size_t bit)
+    {
+        reserve(bit + 1);
+        at(bit / kWordBits) |= Word(1) << (bit % kWordBits);
+    }
+    void reset(size_t bit)
+    {
+        if (bit / kWordBits < nr_words())
+        {
+            at(bit / kWordBits) &= ~(Word(1) << (bit % kWordBits));
+        }
+    }
+    bool test(size_t bit) const
+    {
+        return (word(bit / kWordBits) >> (bit % kWordBits)) & 1;
+    }
+    /**
+     * Make room for @nr_bits, so that setting them does not allocate.
+     */
+    void reserve(size_t nr_bits)
+    {
+        size_t words = (nr_bits + kWordBits - 1) / kWordBits;
+        if (words > nr_words())
+        {
+            rest_.resize(words - 1, 0);
+        }
+    }
+    /**
+     * Unset every bit, keeping the memory.
+     */
+    void clear()
+    {
+        first_ = 0;
+        std::fill(rest_.begin(), rest_.end(), 0);
+    }
+    bool none() const
+    {
+        return first_ == 0 && std::all_of(rest_.begin(),
+                                           rest_.end(),
+                                           [](Word w) { return w == 0; });
+    }
+
+    /**
+     * Whether every bit of @mask is set here.
+     */
+    bool contains(const Bitset &mask) const
+    {
+        for (size_t i = 0; i < mask.nr_words(); ++i)
+        {
+            if ((mask.word(i) & ~word(i)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * Whether every bit of @mask within [@begin, @end) is set here.
+     */
+    bool contains(const Bitset &mask, size_t begin, size_t end) const
+    {
+        for (size_t i = begin / kWordBits; i * kWordBits < end; ++i)
+        {
+            Word range = ~Word(0);
+            if (i == begin / kWordBits)
+            {
+                range &= ~Word(0) << (begin % kWordBits);
+            }
+            if ((i + 1) * kWordBits > end)
+            {
+                range &= ~(~Word(0) << (end % kWordBits));
+            }
+            if ((mask.word(i) & range & ~word(i)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * The number of bits set both here and in @mask.
+     */
+    size_t count_common(const Bitset &mask) const
+    {
+        size_t nr = 0;
+        size_t words = std::min(nr_words(), mask.nr_words());
+        for (size_t i = 0; i < words; ++i)
+        {
+            nr += __builtin_popcountll(word(i) & mask.word(i));
+        }
+        return nr;
+    }
+    /**
+     * Call @f with every bit set in @mask but not here, in order.
+     */
+    template <typename F>
+    void for_each_missing(const Bitset &mask, F &&f) const
+    {
+        for (size_t i = 0; i < mask.nr_words(); ++i)
+        {
+            for_each_bit(mask.word(i) & ~word(i), i, f);
+        }
+    }
+    /**
+     * Call @f with every bit set, in order.
+     */
+    template <typename F>
+    void for_each(F &&f) const
+    {
+        for (size_t i = 0; i < nr_words(); ++i)
+        {
+            for_each_bit(word(i), i, f);
+        }
+    }
+
+private:
+    size_t nr_words() const
+    {
+        return 1 + rest_.size();
+    }
+    Word word(size_t i) const
+    {
+        if (i == 0)
+        {
+            return first_;
+        }
+        return i < nr_words() ? rest_[i - 1] : 0;
+    }
+    Word &at(size_t i)
+    {
+        return i == 0 ? first_ : rest_[i - 1];
+    }
+    template <typename F>
+    static void for_each_bit(Word w, size_t i, F &f)
+    {
+        while (w != 0)
+        {
+            f(i * kWordBits + __builtin_ctzll(w));
+            w &= w - 1;
+        }
+    }
+
+    Word first_{0};
+    // the words after the first one
+    std::pmr::vector<Word> rest_;
+};
+
+/**
+ * A constraint over a set of flags, checked against the applied flags in
+ * one pass over the words of the set.
+ */
+struct FlagGroup
+{
+    enum class Kind
+    {
+        // at most one of the flags is given
+        kExclusive,
+        // at least one of the flags is given
+        kAtLeastOne,
+        // either all or none of the flags are given
+        kAllOrNone,
+    };
+    Kind kind;
+    Bitset mask;
+
+    bool satisfied(const Bitset &applied) const
+    {
+        switch (kind)
+        {
+        case Kind::kExclusive:
+            return applied.count_common(mask) <= 1;
+        case Kind::kAtLeastOne:
+            return applied.count_common(mask) >= 1;
+        case Kind::kAllOrNone:
+            return applied.count_common(mask) == 0 || applied.contains(mask);
+        }
+        return true;
+    }
+    const char *describe() const
+    {
+        switch (kind)
+        {
+        case Kind::kExclusive:
+            return "are mutually exclusive";
+        case Kind::kAtLeastOne:
+            return "need at least one of them";
+        case Kind::kAllOrNone:
+            return "must be given all together or not at all";
+        }
+        return "";
+    }
+};
+
+}  // namespace flag
+}  // namespace argparser
+#endif
@@ -1,26 +1,73 @@
 #ifndef ARG_PARSER_COMMON_H
 #define ARG_PARSER_COMMON_H
+#include <array>
 #include <cctype>
+#include <cstddef>
 #include <string>
+#include <string_view>
+
 namespace argparser
 {
 namespace flag
 {
-inline static bool is_full_flag(const std::string &name)
+// isalpha() of the "C" locale, usable in constant expressions.
+constexpr bool is_alpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+constexpr bool is_full_flag(std::string_view name)
 {
     return name.size() >= 3 && name[0] == '-' && name[1] == '-' &&
-           isalpha(name[2]);
+           is_alpha(name[2]);
 }
-inline static bool is_short_flag(const std::string &name)
+constexpr bool is_short_flag(std::string_view name)
 {
-    return name.size() >= 2 && name[0] == '-' && isalpha(name[1]);
+    return name.size() >= 2 && name[0] == '-' && is_alpha(name[1]);
 }
-inline static bool is_flag(const std::string &str)
+constexpr bool is_flag(std::string_view str)
 {
     return is_full_flag(str) || is_short_flag(str);
 }
-std::vector<std::string> split(std::string str,
-                               const std::string& delimiter)
+/**
+ * "-vxf" or "-T8": short flags given together, when no flag has that name.
+ */
+constexpr bool is_short_bundle(std::string_view str)
+{
+    return str.size() > 2 && is_short_flag(str);
+}
+
+// the one-letter short names, -[a-zA-Z], have a slot in a direct table
+constexpr size_t kNrShortSlots = 52;
+constexpr size_t kNoShortSlot = kNrShortSlots;
+constexpr size_t short_slot(std::string_view name)
+{
+    if (name.size() != 2 || name[0] != '-' || !is_alpha(name[1]))
+    {
+        return kNoShortSlot;
+    }
+    char c = name[1];
+    return c >= 'a' ? size_t(c - 'a') : size_t(26 + c - 'A');
+}
+/**
+ * "-c", for any character @c, without allocating.
+ */
+inline std::string_view short_name_of(char c)
+{
+    static const auto names = [] {
+        std::array<char, 512> ret{};
+        for (size_t i = 0; i < 256; ++i)
+        {
+            ret[2 * i] = '-';
+            ret[2 * i + 1] = static_cast<char>(i);
+        }
+        return ret;
+    }();
+    return std::string_view(names.data() + 2 * static_cast<unsigned char>(c),
+                            2);
+}
+
+inline std::vector<std::string> split(std::string str,
+                                      const std::string& delimiter)
 {
     std::vector<std::string> ret;
     size_t pos = 0;
@@ -50,7 +97,8 @@ std::ostream& operator<<(std::ostream& os, const std::vector<T>& vec)
     os << "]";
     return os;
 }
-std::ostream& operator<<(std::ostream& os, const std::vector<std::string>& vec)
+inline std::ostream& operator<<(std::ostream& os,
+                                const std::vector<std::string>& vec)
 {
     os << "[";
     for (size_t i = 0; i < vec.size(); ++i)
@@ -1,12 +1,24 @@
 #ifndef CONVERT_H
 #define CONVERT_H
+#include <cctype>
+#include <charconv>
 #include <iostream>
+#include <locale>
 #include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "./enum-table.hpp"
 namespace argparse
 {
 namespace convert
 {
 template <typename T>
+bool apply_to(T *target, std::string_view value);
+template <typename T>
 bool apply_to(T *target, const std::string &value);
 
 template <typename T>
@@ -20,50 +32,248 @@ std::optional<T> try_to(const std::string &input)
     return tmp;
 }
 
+namespace detail
+{
+template <typename T>
+struct is_vector : std::false_type
+{
+};
+template <typename T, typename Alloc>
+struct is_vector<std::vector<T, Alloc>> : std::true_type
+{
+};
+// Only a plain char is one character. int8_t and uint8_t are signed and
+// unsigned char, and are parsed as the integers they are used for.
+template <typename T>
+constexpr bool is_char_v = std::is_same_v<T, char>;
+// The types converted by apply_to() itself. The others may have their own
+// try_to() or apply_to() taking a std::string, see try_to(std::string_view).
+template <typename T>
+constexpr bool is_builtin_v = std::is_arithmetic_v<T> ||
+                              std::is_same_v<T, std::string> ||
+                              is_vector<T>::value || has_enum_table_v<T>;
+
+/**
+ * The numbers are parsed by std::from_chars, which neither allocates nor
+ * touches the locale. The accepted forms follow what `std::istream >>` used
+ * to accept: leading white spaces and one sign are skipped, and an unsigned
+ * integer accepts a leading '-' by wrapping around. Numbers out of the range
+ * of the type, including floating-point underflow, are rejected.
+ *
+ * Return the position after the sign. @negative is set if the sign is '-'.
+ */
+inline const char *skip_sign(const char *first,
+                             const char *last,
+                             bool *negative)
+{
+    while (first != last && isspace(static_cast<unsigned char>(*first)))
+    {
+        first++;
+    }
+    *negative = first != last && *first == '-';
+    if (first != last && (*first == '+' || *first == '-'))
+    {
+        first++;
+    }
+    return first;
+}
+template <typename T>
+bool parse_integer(T *target, std::string_view value)
+{
+    const char *last = value.data() + value.size();
+    bool negative;
+    const char *digit = skip_sign(value.data(), last, &negative);
+    if (digit == last || !isdigit(static_cast<unsigned char>(*digit)))
+    {
+        return false;
+    }
+    T tmp;
+    if constexpr (std::is_unsigned_v<T>)
+    {
+        auto [ptr, ec] = std::from_chars(digit, last, tmp);
+        if (ec != std::errc() || ptr != last)
+        {
+            return false;
+        }
+        *target = negative ? static_cast<T>(-tmp) : tmp;
+    }
+    else
+    {
+        const char *first = negative ? digit - 1 : digit;
+        auto [ptr, ec] = std::from_chars(first, last, tmp);
+        if (ec != std::errc() || ptr != last)
+        {
+            return false;
+        }
+        *target = tmp;
+    }
+    return true;
+}
+template <typename T>
+bool parse_floating(T *target, std::string_view value)
+{
+    const char *last = value.data() + value.size();
+    bool negative;
+    const char *digit = skip_sign(value.data(), last, &negative);
+    // "inf" and "nan" are not numbers for us.
+    if (digit == last ||
+        (*digit != '.' && !isdigit(static_cast<unsigned char>(*digit))))
+    {
+        return false;
+    }
+    const char *first = negative ? digit - 1 : digit;
+#if defined(__cpp_lib_to_chars)
+    T tmp;
+    auto [ptr, ec] = std::from_chars(first, last, tmp);
+    if (ec != std::errc() || ptr != last)
+    {
+        return false;
+    }
+    *target = tmp;
+    return true;
+#else
+    // the standard library lacks floating-point from_chars.
+    std::istringstream iss(std::string(first, last));
+    iss.imbue(std::locale::classic());
+    iss >> *target;
+    return iss.eof() && !iss.fail();
+#endif
+}
+template <typename T>
+bool parse_arithmetic(T *target, std::string_view value)
+{
+    if constexpr (is_char_v<T>)
+    {
+        if (value.size() != 1)
+        {
+            return false;
+        }
+        *target = static_cast<T>(value[0]);
+        return true;
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        return parse_integer(target, value);
+    }
+    else
+    {
+        return parse_floating(target, value);
+    }
+}
 template <typename T>
-std::istream &operator>>(std::istream &is, std::vector<T> &vec)
+bool parse_element(T *target, std::string_view value)
+{
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    {
+        return parse_arithmetic(target, value);
+    }
+    else if constexpr (is_builtin_v<T>)
+    {
+        return apply_to<T>(target, value);
+    }
+    else
+    {
+        return apply_to<T>(target, std::string(value));
+    }
+}
+/**
+ * Parse "a,b,c" to a vector. An empty string is parsed to an empty vector.
+ */
+template <typename Vector>
+bool parse_list(Vector *target, std::string_view value)
 {
-    std::string token;
-    vec.clear();
-    if (is.peek() == EOF)
+    using T = typename Vector::value_type;
+    target->clear();
+    if (value.empty())
     {
-        // parse empty string "" to an array
-        // success and the result is an empty array
-        return is;
+        return true;
     }
-    while (!is.eof())
+    while (true)
     {
-        std::getline(is, token, ',');
+        auto pos = value.find(',');
         T tmp;
-        bool succ = apply_to<T>(&tmp, token);
-        if (!succ)
+        if (!parse_element<T>(&tmp, value.substr(0, pos)))
+        {
+            return false;
+        }
+        target->emplace_back(std::move(tmp));
+        if (pos == std::string_view::npos)
         {
-            // manually set fail bit
-            is.setstate(std::ios_base::failbit);
-            return is;
+            return true;
         }
-        vec.emplace_back(std::move(tmp));
+        value.remove_prefix(pos + 1);
     }
-    return is;
 }
+}  // namespace detail
 
 template <typename T>
-bool apply_to(T *target, const std::string &value)
+bool apply_to(T *target, std::string_view value)
 {
     // A space is never allowed except that T is std::string.
-    if (value.find(' ') != std::string::npos)
+    if (value.find(' ') != std::string_view::npos)
     {
         return false;
     }
-    std::istringstream iss(value);
-    iss >> *target;
-    return iss.eof() && !iss.fail();
+    if constexpr (detail::is_vector<T>::value)
+    {
+        return detail::parse_list(target, value);
+    }
+    else if constexpr (has_enum_table_v<T>)
+    {
+        auto maybe = Enum<T>::find(value);
+        if (maybe.has_value())
+        {
+            *target = maybe.value();
+        }
+        return maybe.has_value();
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        return detail::parse_arithmetic(target, value);
+    }
+    else
+    {
+        // fall back to operator>> for other types
+        std::istringstream iss{std::string(value)};
+        iss.imbue(std::locale::classic());
+        iss >> *target;
+        return iss.eof() && !iss.fail();
+    }
+}
+
+template <typename T>
+bool apply_to(T *target, const std::string &value)
+{
+    return apply_to<T>(target, std::string_view(value));
+}
+
+/**
+ * Convert without copying @input first, e.g. a value pointing into argv.
+ * The types not converted by apply_to() itself are handed to
+ * try_to(const std::string &), so that its specializations still apply.
+ */
+template <typename T>
+std::optional<T> try_to(std::string_view input)
+{
+    if constexpr (detail::is_builtin_v<T>)
+    {
+        T tmp;
+        if (!apply_to<T>(&tmp, input))
+        {
+            return {};
+        }
+        return tmp;
+    }
+    else
+    {
+        return try_to<T>(std::string(input));
+    }
 }
 
 template <>
-bool apply_to<bool>(bool *target, const std::string &value)
+inline bool apply_to<bool>(bool *target, std::string_view value)
 {
-    if (value.find(' ') != std::string::npos)
+    if (value.find(' ') != std::string_view::npos)
     {
         return false;
     }
@@ -82,12 +292,12 @@ bool apply_to<bool>(bool *target, const std::string &value)
 }
 
 template <>
-bool apply_to<std::string>(std::string *target, const std::string &value)
+inline bool apply_to<std::string>(std::string *target, std::string_view value)
 {
-    *target = value;
+    target->assign(value.data(), value.size());
     return true;
 }
 
 }  // namespace convert
 }  // namespace argparse
-#endif
\ No newline at end of file
+#endif
@@ -1,16 +1,18 @@
 #ifndef DEBUG_H
 #define DEBUG_H
 #include <ostream>
-#include <list>
-#include <string>
-std::ostream& operator<<(std::ostream& os, std::list<std::pair<std::string, std::string>> pairs)
+
+#include "./tokenizer.hpp"
+namespace argparser
 {
-    if (!pairs.empty())
+inline std::ostream& operator<<(std::ostream& os, const Tokens& tokens)
+{
+    if (!tokens.empty())
     {
         os << "[";
-        for (const auto&[first, second]: pairs)
+        for (const auto& [key, value] : tokens)
         {
-            os << "{" << first << ", " << second << "}, ";
+            os << "{" << key << ", " << value << "}, ";
         }
         os << "]" << std::endl;
     }
@@ -20,4 +22,5 @@ std::ostream& operator<<(std::ostream& os, std::list<std::pair<std::string, std:
     }
     return os;
 }
-#endif
\ No newline at end of file
+}  // namespace argparser
+#endif
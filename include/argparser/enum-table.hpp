@@ -0,0 +1,261 @@
+#ifndef ARG_PARSER_ENUM_TABLE_H
+#define ARG_PARSER_ENUM_TABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace argparse
+{
+namespace convert
+{
+template <typename E>
+struct EnumEntry
+{
+    std::string_view name;
+    E value;
+};
+/**
+ * The names of the values of the enum E. Specialize it, or use
+ * ARGPARSER_ENUM, to make E a flag type:
+ *
+ *   template <>
+ *   struct argparse::convert::EnumTable<Color>
+ *   {
+ *       constexpr static EnumEntry<Color> entries[] = {
+ *           {"red", Color::kRed}, {"blue", Color::kBlue}};
+ *   };
+ */
+template <typename E>
+struct EnumTable
+{
+};
+
+namespace detail
+{
+template <typename E, typename = void>
+struct has_enum_table : std::false_type
+{
+};
+template <typename E>
+struct has_enum_table<E, std::void_t<decltype(EnumTable<E>::entries)>>
+    : std::true_type
+{
+};
+template <typename E, size_t N>
+constexpr std::array<EnumEntry<E>, N> sort_entries()
+{
+    std::array<EnumEntry<E>, N> ret{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        ret[i] = EnumTable<E>::entries[i];
+    }
+    // insertion sort, the tables are short
+    for (size_t i = 1; i < N; ++i)
+    {
+        for (size_t j = i; j > 0 && ret[j].name < ret[j - 1].name; --j)
+        {
+            auto tmp = ret[j];
+            ret[j] = ret[j - 1];
+            ret[j - 1] = tmp;
+        }
+    }
+    return ret;
+}
+template <typename E, size_t N>
+constexpr bool unique_names(const std::array<EnumEntry<E>, N> &sorted)
+{
+    for (size_t i = 1; i < N; ++i)
+    {
+        if (sorted[i].name == sorted[i - 1].name)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace detail
+template <typename E>
+constexpr bool has_enum_table_v = detail::has_enum_table<E>::value;
+
+/**
+ * The entries of EnumTable<E>, sorted by name at compile time. A value is
+ * converted by a binary search; the same table lists the choices in the
+ * help and suggests the nearest name for a rejected value.
+ */
+template <typename E>
+class Enum
+{
+public:
+    constexpr static size_t kSize = std::size(EnumTable<E>::entries);
+    static_assert(kSize > 0, "EnumTable has no entry");
+    constexpr static auto kSorted = detail::sort_entries<E, kSize>();
+    static_assert(detail::unique_names(kSorted),
+                  "EnumTable has duplicated names");
+
+    constexpr static std::optional<E> find(std::string_view name)
+    {
+        size_t lo = 0;
+        size_t hi = kSize;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (kSorted[mid].name < name)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        if (lo < kSize && kSorted[lo].name == name)
+        {
+            return kSorted[lo].value;
+        }
+        return std::nullopt;
+    }
+    /**
+     * "a, b, c", in the order of EnumTable<E>. Built once.
+     */
+    static std::string_view choices()
+    {
+        static const std::string choices = [] {
+            std::string ret;
+            for (const auto &entry : EnumTable<E>::entries)
+            {
+                if (!ret.empty())
+                {
+                    ret.append(", ");
+                }
+                ret.append(entry.name.data(), entry.name.size());
+            }
+            return ret;
+        }();
+        return choices;
+    }
+    /**
+     * The name nearest to the rejected @value, or an empty view if none is
+     * close enough: at most a third of the letters are wrong, ignoring the
+     * case.
+     */
+    static std::string_view suggest(std::string_view value)
+    {
+        // the names in lower case, built once
+        static const std::vector<std::string> candidates = [] {
+            std::vector<std::string> ret;
+            ret.reserve(kSize);
+            for (const auto &entry : kSorted)
+            {
+                ret.emplace_back(lower(entry.name));
+            }
+            return ret;
+        }();
+        auto target = lower(value);
+        size_t best = kSize;
+        size_t best_distance = target.size() / 3 + 1;
+        for (size_t i = 0; i < kSize; ++i)
+        {
+            auto distance = edit_distance(candidates[i], target);
+            if (distance < best_distance)
+            {
+                best = i;
+                best_distance = distance;
+            }
+        }
+        return best == kSize ? std::string_view() : kSorted[best].name;
+    }
+
+private:
+    static std::string lower(std::string_view name)
+    {
+        std::string ret(name);
+        for (auto &c : ret)
+        {
+            c = std::tolower(static_cast<unsigned char>(c));
+        }
+        return ret;
+    }
+    /**
+     * The edit distance where swapping two adjacent letters costs one.
+     */
+    static size_t edit_distance(std::string_view lhs, std::string_view rhs)
+    {
+        size_t width = rhs.size() + 1;
+        std::vector<size_t> rows(3 * width);
+        size_t *prev2 = rows.data();
+        size_t *prev = prev2 + width;
+        size_t *row = prev + width;
+        for (size_t j = 0; j < width; ++j)
+        {
+            prev[j] = j;
+        }
+        for (size_t i = 1; i <= lhs.size(); ++i)
+        {
+            row[0] = i;
+            for (size_t j = 1; j < width; ++j)
+            {
+                size_t replace = prev[j - 1] + (lhs[i - 1] != rhs[j - 1]);
+                row[j] = std::min({prev[j] + 1, row[j - 1] + 1, replace});
+                if (i > 1 && j > 1 && lhs[i - 1] == rhs[j - 2] &&
+                    lhs[i - 2] == rhs[j - 1])
+                {
+                    row[j] = std::min(row[j], prev2[j - 2] + 1);
+                }
+            }
+            std::swap(prev2, prev);
+            std::swap(prev, row);
+        }
+        return prev[rhs.size()];
+    }
+};
+
+/**
+ * The choices and the suggestion of T if it has an EnumTable, otherwise
+ * empty views.
+ */
+template <typename T>
+std::string_view choices_of()
+{
+    if constexpr (has_enum_table_v<T>)
+    {
+        return Enum<T>::choices();
+    }
+    return {};
+}
+template <typename T>
+std::string_view suggest_for(std::string_view value)
+{
+    if constexpr (has_enum_table_v<T>)
+    {
+        return Enum<T>::suggest(value);
+    }
+    std::ignore = value;
+    return {};
+}
+
+}  // namespace convert
+}  // namespace argparse
+
+/**
+ * ARGPARSER_ENUM(Color, {"red", Color::kRed}, {"blue", Color::kBlue});
+ * at the global namespace.
+ */
+#define ARGPARSER_ENUM(E, ...)                                          \
+    template <>                                                         \
+    struct argparse::convert::EnumTable<E>                              \
+    {                                                                   \
+        constexpr static argparse::convert::EnumEntry<E> entries[] = {  \
+            __VA_ARGS__};                                               \
+    }
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef ARG_PARSER_FLAG_INDEX_H
+#define ARG_PARSER_FLAG_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace argparser
+{
+namespace flag
+{
+/**
+ * An open-addressing (linear probing) hash index from flag names to flag
+ * slots.
+ *
+ * Both the full name and the short name of a flag are inserted as keys. The
+ * names are interned into one buffer owned by the index, so the keys stay
+ * valid however the flags themselves are stored and moved.
+ *
+ * A key may be qualified by a @scope, so that one index can hold the names of
+ * several flag-spaces. The same name in different scopes are different keys.
+ */
+class FlagIndex
+{
+public:
+    using Slot = uint32_t;
+    using Scope = uint32_t;
+    constexpr static Slot kNotFound = std::numeric_limits<Slot>::max();
+
+    explicit FlagIndex(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : table_(mr), names_(mr)
+    {
+    }
+    ~FlagIndex() = default;
+
+    /**
+     * Insert @name pointing to @slot.
+     * An empty name is never indexed. If @name is already indexed, the
+     * previous slot is kept and false is returned.
+     */
+    bool insert(std::string_view name, Slot slot, Scope scope = 0)
+    {
+        if (name.empty())
+        {
+            return false;
+        }
+        if ((size_ + 1) * 2 > table_.size())
+        {
+            rehash(std::max(table_.size() * 2, kMinCapacity));
+        }
+        size_t hash = hash_of(name, scope);
+        size_t mask = table_.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+        {
+            auto &entry = table_[pos];
+            if (entry.slot == kNotFound)
+            {
+                entry.hash = hash;
+                entry.offset = names_.size();
+                entry.length = name.size();
+                entry.slot = slot;
+                entry.scope = scope;
+                names_.append(name.data(), name.size());
+                size_++;
+                return true;
+            }
+            if (entry.hash == hash && entry.scope == scope &&
+                key_of(entry) == name)
+            {
+                return false;
+            }
+        }
+    }
+    Slot find(std::string_view name, Scope scope = 0) const
+    {
+        if (name.empty() || table_.empty())
+        {
+            return kNotFound;
+        }
+        size_t hash = hash_of(name, scope);
+        size_t mask = table_.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+        {
+            const auto &entry = table_[pos];
+            if (entry.slot == kNotFound)
+            {
+                return kNotFound;
+            }
+            if (entry.hash == hash && entry.scope == scope &&
+                key_of(entry) == name)
+            {
+                return entry.slot;
+            }
+        }
+    }
+    bool contain(std::string_view name, Scope scope = 0) const
+    {
+        return find(name, scope) != kNotFound;
+    }
+    /**
+     * Reserve the table for @nr_keys keys, so that inserting them triggers
+     * no rehash, and the buffer of the names for @name_bytes more bytes.
+     */
+    void reserve(size_t nr_keys, size_t name_bytes = 0)
+    {
+        names_.reserve(names_.size() + name_bytes);
+        size_t capacity = kMinCapacity;
+        while (capacity < nr_keys * 2)
+        {
+            capacity *= 2;
+        }
+        if (capacity > table_.size())
+        {
+            rehash(capacity);
+        }
+    }
+    size_t size() const
+    {
+        return size_;
+    }
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+private:
+    constexpr static size_t kMinCapacity = 16;
+    struct Entry
+    {
+        size_t hash{0};
+        uint32_t offset{0};
+        uint32_t length{0};
+        Slot slot{kNotFound};
+        Scope scope{0};
+    };
+
+    static size_t hash_of(std::string_view name, Scope scope)
+    {
+        size_t hash = std::hash<std::string_view>{}(name);
+        // mix in the scope, which is zero for most indexes
+        return hash ^ (scope * size_t(0x9e3779b97f4a7c15ull));
+    }
+    std::string_view key_of(const Entry &entry) const
+    {
+        return std::string_view(names_.data() + entry.offset, entry.length);
+    }
+    // @capacity should be a power of two.
+    void rehash(size_t capacity)
+    {
+        std::pmr::vector<Entry> old(capacity, table_.get_allocator());
+        old.swap(table_);
+        size_t mask = table_.size() - 1;
+        for (const auto &entry : old)
+        {
+            if (entry.slot == kNotFound)
+            {
+                continue;
+            }
+            size_t pos = entry.hash & mask;
+            while (table_[pos].slot != kNotFound)
+            {
+                pos = (pos + 1) & mask;
+            }
+            table_[pos] = entry;
+        }
+    }
+
+    std::pmr::vector<Entry> table_;
+    std::pmr::string names_;
+    size_t size_{0};
+};
+
+}  // namespace flag
+}  // namespace argparser
+#endif
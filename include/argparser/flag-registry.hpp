@@ -0,0 +1,295 @@
+#ifndef ARG_PARSER_FLAG_REGISTRY_H
+#define ARG_PARSER_FLAG_REGISTRY_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "./common.hpp"
+#include "./convert.hpp"
+
+/**
+ * Flags defined at namespace scope, in any translation unit:
+ *
+ *   ARGPARSER_DEFINE_FLAG(int, threads, "--threads", "-t", "desc", "4");
+ *   ARGPARSER_DEFINE_REQUIRED_FLAG(std::string, file, "--file", "", "desc");
+ *   ARGPARSER_DECLARE_FLAG(int, threads);  // to use FLAGS_threads elsewhere
+ *
+ * Each macro defines the variable FLAGS_<name> and a constant descriptor.
+ * The descriptors are collected by the linker, and Parser::
+ * load_registered_flags() walks them at startup without copying anything
+ * per flag. argparser::init() loads them into the root parser.
+ *
+ * On ELF targets every executable and shared library collects its own
+ * flags, and chains them for the process during its static initialization:
+ * load the flags from main(), not from a static initializer. An object
+ * file of a static library is only linked if something refers to it, so
+ * a file defining nothing but flags must be linked whole, e.g. through
+ * -Wl,--whole-archive or an OBJECT library.
+ *
+ * The name formats are checked at compile time. Duplicated names across
+ * translation units are reported when the flags are loaded.
+ */
+namespace argparser
+{
+namespace registry
+{
+struct FlagDescriptor
+{
+    const char *full_name;
+    const char *short_name;
+    const char *desc;
+    // nullptr if the flag is required
+    const char *default_val;
+    void *slot;
+    bool (*apply)(void *slot, std::string_view value);
+    bool (*parsable)(std::string_view value);
+};
+
+template <typename T>
+bool apply_slot(void *slot, std::string_view value)
+{
+    auto maybe = argparse::convert::try_to<T>(value);
+    if (!maybe.has_value())
+    {
+        return false;
+    }
+    *static_cast<T *>(slot) = std::move(maybe.value());
+    return true;
+}
+template <typename T>
+bool parsable_as(std::string_view value)
+{
+    return argparse::convert::try_to<T>(value).has_value();
+}
+
+/**
+ * The descriptor of a flag bound to @slot, for a table registered at once
+ * by Parser::flags(). A nullptr @default_val makes the flag required.
+ */
+template <typename T>
+constexpr FlagDescriptor describe(T *slot,
+                                  const char *full_name,
+                                  const char *short_name,
+                                  const char *desc,
+                                  const char *default_val)
+{
+    return FlagDescriptor{full_name,
+                          short_name,
+                          desc,
+                          default_val,
+                          slot,
+                          &apply_slot<T>,
+                          &parsable_as<T>};
+}
+
+/**
+ * The total length of the names of @descriptors[0, @nr).
+ */
+inline size_t name_bytes(const FlagDescriptor *descriptors, size_t nr)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < nr; ++i)
+    {
+        bytes += std::char_traits<char>::length(descriptors[i].full_name) +
+                 std::char_traits<char>::length(descriptors[i].short_name);
+    }
+    return bytes;
+}
+
+/**
+ * The rules of Validator on the name format, usable in static_assert.
+ */
+constexpr bool valid_names(std::string_view full_name,
+                           std::string_view short_name)
+{
+    if (!flag::is_full_flag(full_name) && !flag::is_short_flag(short_name))
+    {
+        return false;
+    }
+    if (!full_name.empty() && !flag::is_full_flag(full_name))
+    {
+        return false;
+    }
+    return short_name.empty() || flag::is_short_flag(short_name);
+}
+
+#if defined(__ELF__)
+// The linker defines __start_/__stop_ symbols around a section whose name
+// is a C identifier, in every executable and shared library holding it.
+// The section holds pointers to the descriptors, so that no padding is
+// ever inserted between the entries. The symbols are referred to as hidden
+// ones, so that each link unit sees its own section.
+#define ARGPARSER_FLAG_SECTION "argparser_flags"
+extern "C" {
+extern const FlagDescriptor *const __start_argparser_flags[]
+    __attribute__((weak, visibility("hidden")));
+extern const FlagDescriptor *const __stop_argparser_flags[]
+    __attribute__((weak, visibility("hidden")));
+}
+/**
+ * The section of one executable or shared library. The sections of all
+ * the link units of the process are chained from section_list().
+ */
+struct Section
+{
+    const FlagDescriptor *const *begin;
+    const FlagDescriptor *const *end;
+    Section *next;
+};
+// Unlike LinkUnit, not hidden, even under -fvisibility=hidden or
+// -fvisibility-inlines-hidden: every link unit must chain its section into
+// the same list, and the static of an inline function is unique across the
+// shared libraries only if the function is visible to the dynamic linker.
+__attribute__((visibility("default"))) inline Section *&section_list()
+{
+    static Section *head = nullptr;
+    return head;
+}
+/**
+ * Chains the section of its link unit during static initialization, and
+ * unchains it when the link unit is unloaded. The class is hidden, so that
+ * the constructor of a shared library is not bound to the one of the
+ * executable, which reads the section of the executable.
+ */
+class __attribute__((visibility("hidden"))) LinkUnit
+{
+public:
+    LinkUnit()
+        : section_{__start_argparser_flags, __stop_argparser_flags, nullptr}
+    {
+        if (section_.begin != nullptr && section_.begin != section_.end)
+        {
+            section_.next = section_list();
+            section_list() = &section_;
+        }
+    }
+    ~LinkUnit()
+    {
+        for (auto **it = &section_list(); *it != nullptr; it = &(*it)->next)
+        {
+            if (*it == &section_)
+            {
+                *it = section_.next;
+                return;
+            }
+        }
+    }
+    LinkUnit(const LinkUnit &) = delete;
+    LinkUnit &operator=(const LinkUnit &) = delete;
+
+private:
+    Section section_;
+};
+// hidden, so that every link unit including the header has its own
+__attribute__((visibility("hidden"))) inline LinkUnit link_unit;
+
+template <typename F>
+void for_each_flag(F &&f)
+{
+    for (auto *section = section_list(); section != nullptr;
+         section = section->next)
+    {
+        for (auto it = section->begin; it != section->end; ++it)
+        {
+            f(**it);
+        }
+    }
+}
+inline size_t nr_flags()
+{
+    size_t nr = 0;
+    for (auto *section = section_list(); section != nullptr;
+         section = section->next)
+    {
+        nr += section->end - section->begin;
+    }
+    return nr;
+}
+#else
+// Without ELF sections, each descriptor links itself into a list during
+// static initialization. The nodes are static, nothing is allocated.
+struct Node
+{
+    const FlagDescriptor *descriptor;
+    Node *next;
+};
+inline Node *&list_head()
+{
+    static Node *head = nullptr;
+    return head;
+}
+struct Registrar
+{
+    explicit Registrar(const FlagDescriptor *descriptor)
+        : node{descriptor, list_head()}
+    {
+        list_head() = &node;
+    }
+    Node node;
+};
+template <typename F>
+void for_each_flag(F &&f)
+{
+    for (Node *node = list_head(); node != nullptr; node = node->next)
+    {
+        f(*node->descriptor);
+    }
+}
+inline size_t nr_flags()
+{
+    size_t nr = 0;
+    for (Node *node = list_head(); node != nullptr; node = node->next)
+    {
+        nr++;
+    }
+    return nr;
+}
+#endif
+
+}  // namespace registry
+}  // namespace argparser
+
+#if defined(__ELF__)
+#define ARGPARSER_REGISTER_DESCRIPTOR_(name)                              \
+    __attribute__((used, section(ARGPARSER_FLAG_SECTION))) static const \
+        ::argparser::registry::FlagDescriptor                             \
+            *const argparser_flag_entry_##name = &argparser_flag_##name
+#else
+#define ARGPARSER_REGISTER_DESCRIPTOR_(name)                 \
+    static ::argparser::registry::Registrar                  \
+        argparser_flag_registrar_##name(&argparser_flag_##name)
+#endif
+
+#define ARGPARSER_REGISTER_FLAG_(                                         \
+    type, name, full_name, short_name, desc, default_val)                 \
+    static_assert(                                                        \
+        ::argparser::registry::valid_names(full_name, short_name),        \
+        "invalid flag name");                                             \
+    static const ::argparser::registry::FlagDescriptor                    \
+        argparser_flag_##name = {                                         \
+            full_name,                                                    \
+            short_name,                                                   \
+            desc,                                                         \
+            default_val,                                                  \
+            &FLAGS_##name,                                                \
+            &::argparser::registry::apply_slot<type>,                     \
+            &::argparser::registry::parsable_as<type>};                   \
+    ARGPARSER_REGISTER_DESCRIPTOR_(name)
+
+#define ARGPARSER_DEFINE_FLAG(                                        \
+    type, name, full_name, short_name, desc, default_val)             \
+    type FLAGS_##name{};                                              \
+    ARGPARSER_REGISTER_FLAG_(                                         \
+        type, name, full_name, short_name, desc, default_val)
+
+#define ARGPARSER_DEFINE_REQUIRED_FLAG(                        \
+    type, name, full_name, short_name, desc)                  \
+    type FLAGS_##name{};                                      \
+    ARGPARSER_REGISTER_FLAG_(                                 \
+        type, name, full_name, short_name, desc, nullptr)
+
+#define ARGPARSER_DECLARE_FLAG(type, name) extern type FLAGS_##name
+
+#endif
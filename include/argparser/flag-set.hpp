@@ -0,0 +1,135 @@
+#ifndef ARG_PARSER_FLAG_SET_H
+#define ARG_PARSER_FLAG_SET_H
+
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "./flag-store.hpp"
+#include "./flag-validator.hpp"
+
+namespace argparser
+{
+class Parser;
+class ParserStore;
+class FrozenParser;
+/**
+ * A named set of flags, defined once and used by many commands through
+ * Parser::use().
+ *
+ * The set owns one FlagStore: the flags, their storage and their help are
+ * shared by every command using the set, and registering the set costs the
+ * same whatever the number of commands. Only one command is parsed at a
+ * time, so the applied flags of the set are those given to the command the
+ * parse enters. They are reset by every parse, like the global flags.
+ * For the same reason, a set is used by sibling commands only: never by a
+ * command and one of its sub-commands, which Parser::use() rejects.
+ *
+ * Define all the flags of a set before using it: the names are checked
+ * against those of a command when the command uses the set.
+ */
+class FlagSet
+{
+public:
+    using Pointer = std::shared_ptr<FlagSet>;
+    FlagSet(const char *name,
+            std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : name_(name, mr),
+          store_(flag::FlagStore::new_instance(mr)),
+          validator_(store_, nullptr)
+    {
+    }
+    FlagSet(const FlagSet &) = delete;
+    FlagSet(FlagSet &&) = delete;
+    FlagSet &operator=(const FlagSet &) = delete;
+    FlagSet &operator=(FlagSet &&) = delete;
+
+    template <typename T>
+    bool flag(T *flag,
+              const char *full_name,
+              const char *short_name,
+              const char *desc,
+              const char *default_val)
+    {
+        if (!validator_.validate(full_name, short_name))
+        {
+            return false;
+        }
+        return store_->add_flag(
+            flag, full_name, short_name, desc, default_val, false);
+    }
+    template <typename T>
+    bool flag(T *flag,
+              const char *full_name,
+              const char *short_name,
+              const char *desc)
+    {
+        if (!validator_.validate(full_name, short_name))
+        {
+            return false;
+        }
+        return store_->add_flag(
+            flag, full_name, short_name, desc, std::nullopt, true);
+    }
+    bool flag(const char *full_name, const char *short_name, const char *desc)
+    {
+        if (!validator_.validate(full_name, short_name))
+        {
+            return false;
+        }
+        return store_->add_flag(
+            full_name, short_name, desc, std::nullopt, true);
+    }
+    bool flag(const char *full_name,
+              const char *short_name,
+              const char *desc,
+              const char *default_val)
+    {
+        if (!validator_.validate(full_name, short_name))
+        {
+            return false;
+        }
+        return store_->add_flag(
+            full_name, short_name, desc, default_val, false);
+    }
+    /**
+     * See Parser::validate_defaults(), which sets it for the sets it uses.
+     */
+    void validate_defaults(bool validate = true)
+    {
+        store_->validate_defaults(validate);
+    }
+    /**
+     * The title of the flags of the set in the help.
+     */
+    const std::pmr::string &name() const
+    {
+        return name_;
+    }
+
+private:
+    friend class Parser;
+    friend class ParserStore;
+    friend class FrozenParser;
+
+    std::pmr::string name_;
+    flag::FlagStore::Pointer store_;
+    flag::Validator validator_;
+};
+
+/**
+ * Create a flag set, whose flags are listed under @name in the help of
+ * every command using it.
+ */
+inline FlagSet::Pointer new_flag_set(
+    const char *name,
+    std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+{
+    return std::allocate_shared<FlagSet>(
+        std::pmr::polymorphic_allocator<FlagSet>(mr), name, mr);
+}
+
+}  // namespace argparser
+#endif
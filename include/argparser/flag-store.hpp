@@ -1,313 +1,709 @@
 #ifndef ARG_PARSER_MANAGER_H
 #define ARG_PARSER_MANAGER_H
 
+#include <array>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "./bitset.hpp"
 #include "./common.hpp"
+#include "./flag-index.hpp"
+#include "./flag-registry.hpp"
 #include "./flag.hpp"
+#include "./help-formatter.hpp"
+#include "./typed-slot.hpp"
 
 namespace argparser
 {
+class FrozenParser;
 namespace flag
 {
+/**
+ * The flags of one scope, laid out as parallel arrays.
+ *
+ * What a parse touches is kept dense: the index of the names, the bitsets
+ * of the required and applied flags, the targets of the typed flags and
+ * the values of the stored flags. The names, descriptions and defaults of
+ * both are a separate cold block, read by the help, by the errors and to
+ * reset an applied flag.
+ *
+ * Every flag has an id, in the order of registration, which is its bit in
+ * the bitsets. The index maps the names to the ids; the one-letter short
+ * names are also read from a direct table of kNrShortSlots ids.
+ *
+ * The defaults are kept unconverted. materialize_defaults() writes them
+ * after a parse, only to the flags left unapplied whose targets do not hold
+ * them already, so a default overridden on every command line is never
+ * converted.
+ */
 class FlagStore
 {
-    using Required = bool;
-    using Applied = bool;
-    using Meta = std::pair<Required, Applied>;
-
 public:
     using Pointer = std::shared_ptr<FlagStore>;
-    static Pointer new_instance()
+    /**
+     * Every allocation of the store, its flags and its index is served by
+     * @mr, which must outlive the store.
+     */
+    static Pointer new_instance(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
     {
-        return std::make_unique<FlagStore>();
+        return std::allocate_shared<FlagStore>(
+            std::pmr::polymorphic_allocator<FlagStore>(mr), mr);
     }
     template <typename T>
     bool add_flag(T *slot,
-                  const std::string &full_name,
-                  const std::string &short_name,
-                  const std::string &desc,
-                  const std::optional<std::string> &default_val,
+                  std::string_view full_name,
+                  std::string_view short_name,
+                  std::string_view desc,
+                  std::optional<std::string_view> default_val,
+                  bool required)
+    {
+        return add_typed_flag(flag::TypedSlot(slot),
+                              full_name,
+                              short_name,
+                              desc,
+                              default_val,
+                              required);
+    }
+    /**
+     * Register a flag bound to the member @member of C. The default value is
+     * written to the object when it is parsed.
+     */
+    template <typename C, typename T>
+    bool add_flag(T C::*member,
+                  std::string_view full_name,
+                  std::string_view short_name,
+                  std::string_view desc,
+                  std::optional<std::string_view> default_val,
                   bool required)
     {
-        auto pair = Meta(required, false);
-        flags_.emplace_back(
-            flag::ConcreteFlag<T>::make_flag(slot, full_name, short_name, desc),
-            std::move(pair));
+        return add_typed_flag(
+            flag::TypedSlot(flag::MemberFlag<C, T>::make_flag(
+                member, full_name, short_name, desc, mr_)),
+            full_name,
+            short_name,
+            desc,
+            default_val,
+            required);
+    }
+    bool add_flag(std::string_view full_name,
+                  std::string_view short_name,
+                  std::string_view desc,
+                  std::optional<std::string_view> default_val,
+                  bool required)
+    {
+        // a stored default is only copied, never converted, so it is
+        // written right away
+        flag::AllocatedFlag allocated_flag(mr_);
         if (default_val.has_value())
         {
-            auto &flag = flags_.back().first;
-            if (!flag->apply(default_val.value()))
-            {
-                std::cerr << "Failed to register flag " << full_name << ": "
-                          << "default value \"" << default_val.value()
-                          << "\" not parsable" << std::endl;
-                // pop the error one
-                flags_.pop_back();
-                return false;
-            }
+            allocated_flag.apply(default_val.value());
         }
+        grow(allocated_flags_, allocated_infos_);
+        allocated_flags_.push_back(std::move(allocated_flag));
+        allocated_infos_.push_back(make_info(
+            full_name, short_name, desc, default_val));
+        index_flag(full_name,
+                   short_name,
+                   (allocated_flags_.size() - 1) | kAllocatedSlot,
+                   required,
+                   false);
 
         max_full_name_len_ = std::max(max_full_name_len_, full_name.size());
         max_short_name_len_ = std::max(max_short_name_len_, short_name.size());
         return true;
     }
-    bool add_flag(const std::string &full_name,
-                  const std::string &short_name,
-                  const std::string &desc,
-                  const std::optional<std::string> &default_val,
-                  bool required)
+    /**
+     * Register a flag defined by ARGPARSER_DEFINE_FLAG. The store refers to
+     * @descriptor, which lives as long as the program, and copies nothing.
+     */
+    bool add_flag(const registry::FlagDescriptor &descriptor)
     {
-        auto meta = Meta(required, false);
-        allocated_flags_.emplace_back(
-            flag::AllocatedFlag(full_name, short_name, desc), std::move(meta));
-        if (default_val.has_value())
+        if (!check_default(descriptor))
         {
-            auto &allocated_flag = allocated_flags_.back().first;
-            if (!allocated_flag.apply(default_val.value()))
-            {
-                std::cerr << "Failed to register flag " << full_name << ": "
-                          << "default value \"" << default_val.value()
-                          << "\" not parsable" << std::endl;
-                // pop the error one
-                allocated_flags_.pop_back();
-                return false;
-            }
+            return false;
         }
-
-        max_full_name_len_ = std::max(max_full_name_len_, full_name.size());
-        max_short_name_len_ = std::max(max_short_name_len_, short_name.size());
+        add_descriptor(descriptor);
         return true;
     }
+    /**
+     * Register @descriptors[0, @nr) whose names and defaults are checked by
+     * the caller, see Parser::flags(). Every array grows once.
+     */
+    void add_flags(const registry::FlagDescriptor *descriptors, size_t nr)
+    {
+        reserve(nr, registry::name_bytes(descriptors, nr));
+        for (size_t i = 0; i < nr; ++i)
+        {
+            add_descriptor(descriptors[i]);
+        }
+    }
+    /**
+     * Make room for @nr more flags of any kind in the index, whose names
+     * take @name_bytes, and for @nr more registered flags.
+     */
+    void reserve(size_t nr, size_t name_bytes = 0)
+    {
+        static_flags_.reserve(static_flags_.size() + nr);
+        slots_.reserve(slots_.size() + nr);
+        required_.reserve(size() + nr);
+        applied_.reserve(size() + nr);
+        stale_.reserve(size() + nr);
+        index_.reserve(2 * (size() + nr), name_bytes);
+    }
     bool empty() const
     {
-        return flags_.empty() && allocated_flags_.empty();
+        return targets_.empty() && allocated_flags_.empty() &&
+               static_flags_.empty();
     }
-    bool apply(const std::string &key, const std::string &value)
+    bool apply(std::string_view key, std::string_view value)
     {
-        for (auto &[flag, meta] : flags_)
+        auto id = find(key);
+        if (id == FlagIndex::kNotFound)
         {
-            bool &applied = meta.second;
-            if (flag->match(key))
-            {
-                if (applied)
-                {
-                    std::cerr << "Failed to apply " << key << "=\"" << value
-                              << "\": "
-                              << "Flag " << key
-                              << " already set and is provided more than once."
-                              << std::endl;
-                    return false;
-                }
-                if (!flag->apply(value))
-                {
-                    std::cerr << "Failed to apply " << key << "=\"" << value
-                              << "\": \"" << value << "\" not parsable"
-                              << std::endl;
-                    return false;
-                }
-                applied = true;
-                return true;
-            }
+            return false;
         }
-        for (auto &[flag, meta] : allocated_flags_)
+        auto slot = slots_[id];
+        if (slot & kAllocatedSlot)
         {
-            bool &applied = meta.second;
-            if (flag.match(key))
-            {
-                if (applied)
-                {
-                    std::cerr << "Failed to apply " << key << "=\"" << value
-                              << "\": "
-                              << "Flag " << key
-                              << " already set and is provided more than once."
-                              << std::endl;
-                    return false;
-                }
-                if (!flag.apply(value))
-                {
-                    std::cerr << "Failed to apply " << key << "=\"" << value
-                              << "\": \"" << value << "\" not parsable"
-                              << std::endl;
-                    return false;
-                }
-                applied = true;
-                return true;
-            }
+            slot &= ~kAllocatedSlot;
+            return do_apply(id, allocated_flags_[slot], key, value);
         }
-        return false;
+        if (slot & kStaticSlot)
+        {
+            slot &= ~kStaticSlot;
+            return do_apply(
+                id, DescriptorTarget{static_flags_[slot]}, key, value);
+        }
+        return do_apply(id, targets_[slot], key, value);
     }
-    bool contain(const std::string name) const
+    bool contain(std::string_view name) const
     {
-        for (const auto &flagline : flags_)
+        return find(name) != FlagIndex::kNotFound;
+    }
+    /**
+     * Whether @name is a bool flag bound to a variable, which a bundle of
+     * short flags gives without a value. A stored flag has no type and
+     * always takes a value.
+     */
+    bool is_switch(std::string_view name) const
+    {
+        auto slot = slot_of(name);
+        if (slot == FlagIndex::kNotFound || (slot & kAllocatedSlot))
         {
-            if (flagline.first->match(name))
-            {
-                return true;
-            }
+            return false;
         }
-        for (const auto &flagline : allocated_flags_)
+        if (slot & kStaticSlot)
         {
-            if (flagline.first.match(name))
-            {
-                return true;
-            }
+            return static_flags_[slot & ~kStaticSlot]->apply ==
+                   &registry::apply_slot<bool>;
         }
-        return false;
+        return targets_[slot].is_switch();
     }
-    const flag::AllocatedFlag &get(const std::string &name) const
+    const flag::AllocatedFlag &get(std::string_view name) const
     {
-        for (const auto &[flag, meta] : allocated_flags_)
+        if (const auto *flag = get_if(name))
         {
-            std::ignore = meta;
-            if (flag.match(name))
-            {
-                return flag;
-            }
+            return *flag;
         }
         std::cerr << "Failed to get " << name << ": not found." << std::endl;
         std::terminate();
     }
-    bool has(const std::string &name) const
+    /**
+     * The stored flag @name, or nullptr if there is none.
+     */
+    const flag::AllocatedFlag *get_if(std::string_view name) const
     {
-        for (const auto &[flag, meta] : allocated_flags_)
+        auto slot = slot_of(name);
+        if (slot != FlagIndex::kNotFound && (slot & kAllocatedSlot))
         {
-            std::ignore = meta;
-            if (flag.match(name))
-            {
-                return true;
-            }
+            return &allocated_flags_[slot & ~kAllocatedSlot];
         }
-        return false;
+        return nullptr;
+    }
+    bool has(std::string_view name) const
+    {
+        return get_if(name) != nullptr;
     }
     size_t size() const
     {
-        return flags_.size() + allocated_flags_.size();
+        return targets_.size() + allocated_flags_.size() +
+               static_flags_.size();
+    }
+    /**
+     * The full and short names of the flag @id, in the order of
+     * registration.
+     */
+    std::pair<std::string_view, std::string_view> names_of(size_t id) const
+    {
+        auto slot = slots_[id];
+        if (slot & kStaticSlot)
+        {
+            const auto *descriptor = static_flags_[slot & ~kStaticSlot];
+            return {descriptor->full_name, descriptor->short_name};
+        }
+        const auto &info = info_of(slot);
+        return {info.full_name, info.short_name};
+    }
+    /**
+     * Forget the flags applied by the last parse, so that the store can be
+     * parsed again. Their defaults are restored by materialize_defaults().
+     */
+    void reset()
+    {
+        applied_.clear();
+    }
+    /**
+     * Write the defaults of the flags left unapplied by the parse, unless
+     * their targets hold them already. A default that does not convert is
+     * reported and fails.
+     */
+    bool materialize_defaults()
+    {
+        bool succ = true;
+        applied_.for_each_missing(stale_, [this, &succ](size_t id) {
+            stale_.reset(id);
+            succ = write_default(id) && succ;
+        });
+        return succ;
+    }
+    /**
+     * Convert the default of every flag registered from now on, and report
+     * a malformed one at registration rather than at the first parse
+     * leaving the flag unapplied.
+     */
+    void validate_defaults(bool validate)
+    {
+        validate_defaults_ = validate;
+    }
+    /**
+     * Whether the @descriptor default is fine, or not checked, see
+     * validate_defaults().
+     */
+    bool check_default(const registry::FlagDescriptor &descriptor) const
+    {
+        if (!validate_defaults_ || descriptor.default_val == nullptr ||
+            descriptor.parsable(descriptor.default_val))
+        {
+            return true;
+        }
+        report_default(descriptor.full_name, descriptor.default_val);
+        return false;
+    }
+    /**
+     * Whether every required flag is applied: one masked compare per 64
+     * flags.
+     */
+    bool complete() const
+    {
+        return applied_.contains(required_);
     }
     using FlagId = std::tuple<std::string, std::string>;
+    /**
+     * The required flags not applied. Only worth calling if !complete().
+     */
     std::vector<FlagId> missing_keys() const
     {
         std::vector<FlagId> ret;
-        for (const auto &[flag, meta] : flags_)
+        applied_.for_each_missing(required_, [this, &ret](size_t id) {
+            auto [full_name, short_name] = names_of(id);
+            ret.emplace_back(full_name, short_name);
+        });
+        return ret;
+    }
+    /**
+     * Constrain the flags @names as a group, see FlagGroup. All of them must
+     * be registered already.
+     */
+    bool add_group(FlagGroup::Kind kind,
+                   std::initializer_list<std::string_view> names)
+    {
+        FlagGroup group{kind, Bitset(mr_)};
+        for (auto name : names)
         {
-            const bool &required = meta.first;
-            const bool &applied = meta.second;
-            if (required && !applied)
+            auto id = find(name);
+            if (id == FlagIndex::kNotFound)
             {
-                ret.emplace_back(flag->full_name(), flag->short_name());
+                std::cerr << "Failed to add flag group: flag " << name
+                          << " not found" << std::endl;
+                return false;
             }
+            group.mask.set(id);
         }
-        for (const auto &[flag, meta] : allocated_flags_)
+        groups_.push_back(std::move(group));
+        return true;
+    }
+    /**
+     * Whether the applied flags satisfy every group. Report the first group
+     * violated.
+     */
+    bool check_groups() const
+    {
+        for (const auto &group : groups_)
         {
-            const bool &required = meta.first;
-            const bool &applied = meta.second;
-            if (required && !applied)
+            if (group.satisfied(applied_))
             {
-                ret.emplace_back(flag.full_name(), flag.short_name());
+                continue;
             }
+            std::cerr << "Failed to parse command line: flags [";
+            group.mask.for_each([this](size_t id) {
+                auto [full_name, short_name] = names_of(id);
+                std::cerr << (full_name.empty() ? short_name : full_name)
+                          << ", ";
+            });
+            std::cerr << "] " << group.describe() << "." << std::endl;
+            return false;
         }
-        return ret;
+        return true;
     }
-    // TODO: make it formator
     void print_flags(const std::string &title = "Flags") const
+    {
+        HelpFormatter formatter;
+        format_flags(formatter, title);
+        formatter.write_to(std::cout);
+    }
+    void format_flags(HelpFormatter &formatter,
+                      std::string_view title = "Flags") const
     {
         if (empty())
         {
             return;
         }
-        std::cout << title << ":" << std::endl;
-        for (const auto &[flag, meta] : flags_)
-        {
-            std::ignore = meta;
-            auto short_name = flag->short_name();
-            auto full_name = flag->full_name();
-            std::cout << "  ";
-            std::cout << std::string(max_short_name_len_ - short_name.size(),
-                                     ' ');
-            std::cout << short_name << (short_name.empty() ? "  " : ", ");
-            std::cout << full_name;
-            std::cout << std::endl;
-            size_t padding_len =
-                2 + max_short_name_len_ + 2 + max_full_name_len_ + 2;
-            auto padding_str = std::string(padding_len, ' ');
-            std::cout << padding_str;
-            auto desc = flag->desc();
-            size_t pos = 0;
-            std::string token;
-            size_t current_column = 0;
-            while ((pos = desc.find(" ")) != std::string::npos)
+        formatter.append(title).line(":");
+        for (size_t i = 0; i < targets_.size(); ++i)
+        {
+            const auto &info = target_infos_[i];
+            format_flag(formatter,
+                        info.short_name,
+                        info.full_name,
+                        info.desc,
+                        targets_[i].choices());
+        }
+        for (const auto &info : allocated_infos_)
+        {
+            format_flag(
+                formatter, info.short_name, info.full_name, info.desc);
+        }
+        for (const auto *descriptor : static_flags_)
+        {
+            format_flag(formatter,
+                        descriptor->short_name,
+                        descriptor->full_name,
+                        descriptor->desc);
+        }
+    }
+
+    explicit FlagStore(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : mr_(mr),
+          targets_(mr),
+          target_infos_(mr),
+          allocated_flags_(mr),
+          allocated_infos_(mr),
+          static_flags_(mr),
+          slots_(mr),
+          required_(mr),
+          applied_(mr),
+          stale_(mr),
+          groups_(mr),
+          index_(mr)
+    {
+        short_ids_.fill(FlagIndex::kNotFound);
+    }
+
+    ~FlagStore() = default;
+
+private:
+    constexpr static size_t kDescWidth = 80;
+    void format_flag(HelpFormatter &formatter,
+                     std::string_view short_name,
+                     std::string_view full_name,
+                     std::string_view desc,
+                     std::string_view choices = {}) const
+    {
+        formatter.pad(2 + max_short_name_len_ - short_name.size())
+            .append(short_name)
+            .append(short_name.empty() ? "  " : ", ")
+            .line(full_name);
+        size_t indent = 2 + max_short_name_len_ + 2 + max_full_name_len_ + 2;
+        formatter.pad(indent).wrap(desc, indent, kDescWidth);
+        if (!choices.empty())
+        {
+            formatter.pad(indent).append("choices: ");
+            formatter.wrap(choices, indent + 9, kDescWidth);
+        }
+        formatter.line();
+    }
+
+    // slots of allocated_flags_ are tagged with the highest bit in slots_,
+    // slots of static_flags_ with the next one.
+    constexpr static FlagIndex::Slot kAllocatedSlot = 1u << 31;
+    constexpr static FlagIndex::Slot kStaticSlot = 1u << 30;
+
+    FlagIndex::Slot find(std::string_view name) const
+    {
+        auto letter = short_slot(name);
+        if (letter != kNoShortSlot)
+        {
+            return short_ids_[letter];
+        }
+        return index_.find(name);
+    }
+    FlagIndex::Slot slot_of(std::string_view name) const
+    {
+        auto id = find(name);
+        return id == FlagIndex::kNotFound ? id : slots_[id];
+    }
+    /**
+     * Write the default of the flag @id, if it has one.
+     */
+    bool write_default(size_t id)
+    {
+        auto slot = slots_[id];
+        if (slot & kAllocatedSlot)
+        {
+            slot &= ~kAllocatedSlot;
+            const auto &default_val = allocated_infos_[slot].default_val;
+            if (default_val.has_value())
             {
-                token = desc.substr(0, pos);
-                current_column += token.size();
-                if (current_column >= 80)
-                {
-                    current_column = 0;
-                    std::cout << std::endl << padding_str;
-                }
-                std::cout << token << " ";
-                desc.erase(0, pos + 1);
+                allocated_flags_[slot].apply(default_val.value());
             }
-            std::cout << desc;
-            std::cout << std::endl << std::endl;
-        }
-        for (const auto &[flag, meta] : allocated_flags_)
-        {
-            std::ignore = meta;
-            auto short_name = flag.short_name();
-            auto full_name = flag.full_name();
-            std::cout << "  ";
-            std::cout << std::string(max_short_name_len_ - short_name.size(),
-                                     ' ');
-            std::cout << short_name << (short_name.empty() ? "  " : ", ");
-            std::cout << full_name;
-            std::cout << std::endl;
-            size_t padding_len =
-                2 + max_short_name_len_ + 2 + max_full_name_len_ + 2;
-            auto padding_str = std::string(padding_len, ' ');
-            std::cout << padding_str;
-            auto desc = flag.desc();
-            size_t pos = 0;
-            std::string token;
-            size_t current_column = 0;
-            while ((pos = desc.find(" ")) != std::string::npos)
+            return true;
+        }
+        if (slot & kStaticSlot)
+        {
+            const auto &descriptor = *static_flags_[slot & ~kStaticSlot];
+            if (descriptor.default_val != nullptr &&
+                !descriptor.apply(descriptor.slot, descriptor.default_val))
             {
-                token = desc.substr(0, pos);
-                current_column += token.size();
-                if (current_column >= 80)
-                {
-                    current_column = 0;
-                    std::cout << std::endl << padding_str;
-                }
-                std::cout << token << " ";
-                desc.erase(0, pos + 1);
+                report_default(descriptor.full_name, descriptor.default_val);
+                return false;
             }
-            std::cout << desc;
-            std::cout << std::endl;
+            return true;
         }
-        std::cout << std::endl;
+        const auto &info = target_infos_[slot];
+        if (info.default_val.has_value() &&
+            !targets_[slot].apply(info.default_val.value()))
+        {
+            report_default(info.full_name, info.default_val.value());
+            return false;
+        }
+        return true;
+    }
+    static void report_default(std::string_view full_name,
+                               std::string_view default_val)
+    {
+        std::cerr << "Failed to register flag " << full_name << ": "
+                  << "default value \"" << default_val << "\" not parsable"
+                  << std::endl;
     }
 
-    FlagStore() = default;
+    // the cold part of a typed or a stored flag
+    struct FlagInfo
+    {
+        std::pmr::string full_name;
+        std::pmr::string short_name;
+        std::pmr::string desc;
+        // kept unconverted, so that the flag can be reset to it.
+        std::optional<std::pmr::string> default_val;
+    };
+    // a flag of the registry, seen as the target of do_apply()
+    struct DescriptorTarget
+    {
+        const registry::FlagDescriptor *descriptor;
+        bool apply(std::string_view value) const
+        {
+            return descriptor->apply(descriptor->slot, value);
+        }
+        std::string_view suggest(std::string_view) const
+        {
+            return {};
+        }
+    };
 
-    ~FlagStore() = default;
+    void add_descriptor(const registry::FlagDescriptor &descriptor)
+    {
+        std::string_view full_name = descriptor.full_name;
+        std::string_view short_name = descriptor.short_name;
+        grow(static_flags_);
+        static_flags_.push_back(&descriptor);
+        index_flag(full_name,
+                   short_name,
+                   (static_flags_.size() - 1) | kStaticSlot,
+                   descriptor.default_val == nullptr,
+                   descriptor.default_val != nullptr);
 
-private:
-    // FlagLine = {pointer, {bool, bool}}
-    using FlagLine = std::pair<flag::Flag::Pointer, Meta>;
-    using AllocatedFlagLine = std::pair<flag::AllocatedFlag, Meta>;
-    std::vector<FlagLine> flags_;
-    std::vector<AllocatedFlagLine> allocated_flags_;
+        max_full_name_len_ = std::max(max_full_name_len_, full_name.size());
+        max_short_name_len_ = std::max(max_short_name_len_, short_name.size());
+    }
+    /**
+     * Give the flag at @slot the next id. A @stale flag has a default not
+     * written yet: the first parse leaving it unapplied writes it.
+     */
+    void index_flag(std::string_view full_name,
+                    std::string_view short_name,
+                    FlagIndex::Slot slot,
+                    bool required,
+                    bool stale)
+    {
+        FlagIndex::Slot id = slots_.size();
+        grow(slots_);
+        slots_.push_back(slot);
+        index_.insert(full_name, id);
+        index_.insert(short_name, id);
+        auto letter = short_slot(short_name);
+        if (letter != kNoShortSlot)
+        {
+            short_ids_[letter] = id;
+        }
+        if (required)
+        {
+            required_.set(id);
+        }
+        if (stale)
+        {
+            stale_.set(id);
+        }
+        applied_.reserve(id + 1);
+    }
+    /**
+     * @flag is a TypedSlot, an AllocatedFlag or a DescriptorTarget.
+     */
+    template <typename Target>
+    bool do_apply(size_t id,
+                  Target &&flag,
+                  std::string_view key,
+                  std::string_view value)
+    {
+        if (applied_.test(id))
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value << "\": "
+                      << "Flag " << key
+                      << " already set and is provided more than once."
+                      << std::endl;
+            return false;
+        }
+        if (!flag.apply(value))
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value
+                      << "\": \"" << value << "\" not parsable";
+            auto suggestion = flag.suggest(value);
+            if (!suggestion.empty())
+            {
+                std::cerr << ", did you mean \"" << suggestion << "\"?";
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+        applied_.set(id);
+        stale_.set(id);
+        return true;
+    }
+
+    /**
+     * Grow the parallel arrays of one kind of flags together, by at least
+     * kMinCapacity, so that a small store allocates every array once.
+     */
+    constexpr static size_t kMinCapacity = 4;
+    template <typename Column, typename... Columns>
+    static void grow(Column &column, Columns &...columns)
+    {
+        if (column.size() < column.capacity())
+        {
+            return;
+        }
+        size_t capacity = std::max(kMinCapacity, 2 * column.capacity());
+        column.reserve(capacity);
+        (columns.reserve(capacity), ...);
+    }
+    FlagInfo make_info(std::string_view full_name,
+                       std::string_view short_name,
+                       std::string_view desc,
+                       std::optional<std::string_view> default_val) const
+    {
+        FlagInfo info{std::pmr::string(full_name, mr_),
+                      std::pmr::string(short_name, mr_),
+                      std::pmr::string(desc, mr_),
+                      std::nullopt};
+        if (default_val.has_value())
+        {
+            info.default_val.emplace(default_val.value(), mr_);
+        }
+        return info;
+    }
+    /**
+     * The cold part of the typed or stored flag at @slot.
+     */
+    const FlagInfo &info_of(FlagIndex::Slot slot) const
+    {
+        if (slot & kAllocatedSlot)
+        {
+            return allocated_infos_[slot & ~kAllocatedSlot];
+        }
+        return target_infos_[slot];
+    }
+    bool add_typed_flag(flag::TypedSlot target,
+                        std::string_view full_name,
+                        std::string_view short_name,
+                        std::string_view desc,
+                        std::optional<std::string_view> default_val,
+                        bool required)
+    {
+        if (validate_defaults_ && default_val.has_value() &&
+            !target.parsable(default_val.value()))
+        {
+            report_default(full_name, default_val.value());
+            return false;
+        }
+        grow(targets_, target_infos_);
+        targets_.push_back(std::move(target));
+        target_infos_.push_back(
+            make_info(full_name, short_name, desc, default_val));
+        index_flag(full_name,
+                   short_name,
+                   targets_.size() - 1,
+                   required,
+                   default_val.has_value());
+
+        max_full_name_len_ = std::max(max_full_name_len_, full_name.size());
+        max_short_name_len_ = std::max(max_short_name_len_, short_name.size());
+        return true;
+    }
+
+    friend class argparser::FrozenParser;
 
-    std::vector<bool> required_;
-    std::vector<bool> applied_;
+    std::pmr::memory_resource *mr_;
+    // typed flags: hot targets, cold names
+    std::pmr::vector<flag::TypedSlot> targets_;
+    std::pmr::vector<FlagInfo> target_infos_;
+    // stored flags: hot values, cold names
+    std::pmr::vector<flag::AllocatedFlag> allocated_flags_;
+    std::pmr::vector<FlagInfo> allocated_infos_;
+    // flags of the registry
+    std::pmr::vector<const registry::FlagDescriptor *> static_flags_;
+    // the slot of every flag in the arrays above, by id
+    std::pmr::vector<FlagIndex::Slot> slots_;
+    Bitset required_;
+    Bitset applied_;
+    // the flags whose targets do not hold their defaults
+    Bitset stale_;
+    std::pmr::vector<FlagGroup> groups_;
+    // full and short names of all the flags, to their ids
+    FlagIndex index_;
+    std::array<FlagIndex::Slot, kNrShortSlots> short_ids_;
 
     size_t max_full_name_len_{0};
     size_t max_short_name_len_{0};
+    bool validate_defaults_{true};
 };
 
 }  // namespace flag
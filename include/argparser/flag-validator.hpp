@@ -1,8 +1,7 @@
 #ifndef FLAG_VALIDATOR_H
 #define FLAG_VALIDATOR_H
 #include <iostream>
-#include <set>
-#include <string>
+#include <string_view>
 
 #include "./common.hpp"
 #include "./flag-store.hpp"
@@ -13,10 +12,12 @@ namespace flag
 class Validator
 {
 public:
-    Validator(flag::FlagStore::Pointer gf_store) : gf_store_(gf_store)
+    Validator(flag::FlagStore::Pointer flag_store,
+              flag::FlagStore::Pointer gf_store)
+        : flag_store_(flag_store), gf_store_(gf_store)
     {
     }
-    bool validate(const std::string &full_name, const std::string &short_name)
+    bool validate(std::string_view full_name, std::string_view short_name)
     {
         if (!flag::is_full_flag(full_name) && !flag::is_short_flag(short_name))
         {
@@ -38,48 +39,34 @@ public:
                       << ": identity not allowed" << std::endl;
             return false;
         }
-        if (!unique_full_flag(full_name))
+        if (flag_store_->contain(full_name))
         {
             std::cerr << "Failed to register flag " << full_name
                       << ": flag already registered" << std::endl;
             return false;
         }
-        if (!unique_short_flag(short_name))
+        if (flag_store_->contain(short_name))
         {
             std::cerr << "Failed to register flag " << short_name << "("
                       << full_name << ")"
                       << ": flag already registered" << std::endl;
             return false;
         }
-        if (gf_store_->contain(full_name) || gf_store_->contain(short_name))
+        if (gf_store_ != nullptr &&
+            (gf_store_->contain(full_name) || gf_store_->contain(short_name)))
         {
             std::cerr << "Flag registered failed: flag \"" << full_name
                       << "\", \"" << short_name
                       << "\" conflict with global flag" << std::endl;
             return false;
         }
-        if (!full_name.empty())
-        {
-            inserted_full_names_.insert(full_name);
-        }
-        if (!short_name.empty())
-        {
-            inserted_short_names_.insert(short_name);
-        }
         return true;
     }
-    bool unique_full_flag(const std::string &name) const
-    {
-        return inserted_full_names_.find(name) == inserted_full_names_.end();
-    }
-    bool unique_short_flag(const std::string &name) const
-    {
-        return inserted_short_names_.find(name) == inserted_short_names_.end();
-    }
 
 private:
-    std::set<std::string> inserted_full_names_;
-    std::set<std::string> inserted_short_names_;
+    // the names are checked against the hashed indexes of the stores; a
+    // store without global flags, e.g. of a FlagSet, has a null gf_store_
+    flag::FlagStore::Pointer flag_store_;
     flag::FlagStore::Pointer gf_store_;
 };
 }  // namespace flag
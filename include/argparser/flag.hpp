@@ -3,12 +3,18 @@
 
 #include <iostream>
 #include <istream>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <tuple>
 
 #include "./convert.hpp"
+#include "./typed-cache.hpp"
 
 namespace argparser
 {
+class FrozenParser;
 namespace flag
 {
 class FlagStore;
@@ -16,104 +22,191 @@ class Flag
 {
 public:
     using Pointer = std::shared_ptr<Flag>;
-    Flag(const std::string &full_name,
-         const std::string &short_name,
-         const std::string &desc)
-        : full_name_(full_name), short_name_(short_name), desc_(desc)
+    Flag(std::string_view full_name,
+         std::string_view short_name,
+         std::string_view desc,
+         std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : full_name_(full_name, mr),
+          short_name_(short_name, mr),
+          desc_(desc, mr)
     {
     }
+    Flag(const Flag &) = default;
+    Flag(Flag &&) = default;
+    Flag &operator=(const Flag &) = default;
+    Flag &operator=(Flag &&) = default;
     virtual ~Flag() = default;
 
-    virtual bool apply(const std::string &value) = 0;
+    virtual bool apply(std::string_view value) = 0;
+    /**
+     * Whether apply(@value) would succeed, without applying it.
+     */
+    virtual bool parsable(std::string_view value) const
+    {
+        std::ignore = value;
+        return true;
+    }
+    /**
+     * Whether apply() writes the value somewhere. A flag bound to a member
+     * has no target until an object is given.
+     */
+    virtual bool has_target() const
+    {
+        return true;
+    }
+    /**
+     * The accepted values, "a, b, c", if the type of the flag is an enum
+     * with an EnumTable. Otherwise empty.
+     */
+    virtual std::string_view choices() const
+    {
+        return {};
+    }
+    /**
+     * The accepted value nearest to the rejected @value, or empty.
+     */
+    virtual std::string_view suggest(std::string_view value) const
+    {
+        std::ignore = value;
+        return {};
+    }
+    /**
+     * The class whose member the flag is bound to, as the tag of
+     * MemberFlagBase, or nullptr.
+     */
+    virtual const void *member_class() const
+    {
+        return nullptr;
+    }
 
-    virtual std::string short_name() const
+    virtual const std::pmr::string &short_name() const
     {
         return short_name_;
     }
-    virtual std::string full_name() const
+    virtual const std::pmr::string &full_name() const
     {
         return full_name_;
     }
-    virtual std::string desc() const
+    virtual const std::pmr::string &desc() const
     {
         return desc_;
     }
-    virtual bool match(const std::string &key) const
+
+private:
+    std::pmr::string full_name_;
+    std::pmr::string short_name_;
+    std::pmr::string desc_;
+};
+
+/**
+ * A flag bound to a member of C instead of a variable. It has no storage of
+ * its own: apply() only checks the value, and apply_to() writes it to the
+ * member of a given object.
+ */
+template <typename C>
+class MemberFlagBase : public Flag
+{
+public:
+    using Flag::Flag;
+    bool apply(std::string_view value) override
     {
-        // never match an empty string.
-        if (key.empty())
-        {
-            return false;
-        }
-        return key == full_name_ || key == short_name_;
+        return parsable(value);
     }
-    virtual std::string to_string() const
+    bool has_target() const override
     {
-        return "{Flag " + full_name_ + ", " + short_name_ + "}";
+        return false;
     }
-
-private:
-    std::string full_name_;
-    std::string short_name_;
-    std::string desc_;
+    const void *member_class() const override
+    {
+        return class_tag();
+    }
+    /**
+     * One address per C, so that the flags bound to members of C are told
+     * apart without a dynamic_cast.
+     */
+    static const void *class_tag()
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+    virtual bool apply_to(C &object, std::string_view value) const = 0;
 };
-template <typename T>
-class ConcreteFlag : public Flag
+template <typename C, typename T>
+class MemberFlag : public MemberFlagBase<C>
 {
 public:
-    ConcreteFlag(T *flag,
-                 const std::string &full_name,
-                 const std::string &short_name,
-                 const std::string &desc)
-        : Flag(full_name, short_name, desc), flag_(flag)
+    MemberFlag(T C::*member,
+               std::string_view full_name,
+               std::string_view short_name,
+               std::string_view desc,
+               std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : MemberFlagBase<C>(full_name, short_name, desc, mr), member_(member)
     {
     }
-    static std::shared_ptr<ConcreteFlag<T>> make_flag(
-        T *flag,
-        const std::string &full_name,
-        const std::string &short_name,
-        const std::string &desc)
+    static std::shared_ptr<MemberFlag<C, T>> make_flag(
+        T C::*member,
+        std::string_view full_name,
+        std::string_view short_name,
+        std::string_view desc,
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
     {
-        return std::make_shared<ConcreteFlag<T>>(
-            flag, full_name, short_name, desc);
+        return std::allocate_shared<MemberFlag<C, T>>(
+            std::pmr::polymorphic_allocator<MemberFlag<C, T>>(mr),
+            member,
+            full_name,
+            short_name,
+            desc,
+            mr);
     }
-    bool apply(const std::string &value) override
+    bool apply_to(C &object, std::string_view value) const override
     {
         std::optional<T> maybe = argparse::convert::try_to<T>(value);
         if (maybe.has_value())
         {
-            *flag_ = std::move(maybe.value());
+            object.*member_ = std::move(maybe.value());
             return true;
         }
         return false;
     }
-    ~ConcreteFlag() = default;
+    bool parsable(std::string_view value) const override
+    {
+        return argparse::convert::try_to<T>(value).has_value();
+    }
+    std::string_view choices() const override
+    {
+        return argparse::convert::choices_of<T>();
+    }
+    std::string_view suggest(std::string_view value) const override
+    {
+        return argparse::convert::suggest_for<T>(value);
+    }
 
-protected:
-    T *flag_;
+private:
+    T C::*member_;
 };
 
-class AllocatedFlag : public Flag
+/**
+ * The value of a stored flag, kept as given and converted on demand. It
+ * holds nothing else: the names and the description of the flag are kept
+ * apart by its FlagStore, so that the values stay dense.
+ */
+class AllocatedFlag
 {
 public:
-    AllocatedFlag(const std::string &full_name,
-                  const std::string &short_name,
-                  const std::string &desc)
-        : Flag(full_name, short_name, desc)
-    {
-    }
-    static std::shared_ptr<AllocatedFlag> make_flag(
-        const std::string &full_name,
-        const std::string &short_name,
-        const std::string &desc)
+    explicit AllocatedFlag(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : inner_(mr)
     {
-        return std::make_shared<AllocatedFlag>(full_name, short_name, desc);
     }
 
+    /**
+     * The conversion is done once per type and cached until the flag is
+     * applied again.
+     */
     template <typename T>
     T to() const
     {
-        std::optional<T> maybe = argparse::convert::try_to<T>(inner_);
+        const auto &maybe = cached<T>();
         if (maybe.has_value())
         {
             return maybe.value();
@@ -125,33 +218,49 @@ public:
     template <typename T>
     bool convertable_to() const
     {
-        std::optional<T> maybe = argparse::convert::try_to<T>(inner_);
-        return maybe.has_value();
+        return cached<T>().has_value();
     }
-    const std::string &inner() const
+    const std::pmr::string &inner() const
     {
         return inner_;
     }
 
 private:
     friend FlagStore;
-    bool apply(const std::string &value) override
+    friend class argparser::FrozenParser;
+    bool apply(std::string_view value)
     {
-        inner_ = value;
+        inner_.assign(value.data(), value.size());
+        cache_.clear();
         return true;
     }
+    std::string_view suggest(std::string_view) const
+    {
+        return {};
+    }
+    template <typename T>
+    const std::optional<T> &cached() const
+    {
+        return cache_.get<T>(
+            [this]()
+            {
+                return argparse::convert::try_to<T>(
+                    std::string_view(inner_));
+            });
+    }
 
-    std::string inner_;
+    std::pmr::string inner_;
+    TypedCache cache_;
 };
 
 template <>
-std::string AllocatedFlag::to<std::string>() const
+inline std::string AllocatedFlag::to<std::string>() const
 {
-    return inner_;
+    return std::string(inner_);
 }
 
 template <>
-bool AllocatedFlag::convertable_to<std::string>() const
+inline bool AllocatedFlag::convertable_to<std::string>() const
 {
     return !inner_.empty();
 }
@@ -0,0 +1,738 @@
+#ifndef ARG_PARSER_FROZEN_PARSER_H
+#define ARG_PARSER_FROZEN_PARSER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "./bitset.hpp"
+#include "./common.hpp"
+#include "./flag-index.hpp"
+#include "./flag-store.hpp"
+#include "./flag.hpp"
+#include "./parser.hpp"
+#include "./tokenizer.hpp"
+
+namespace argparser
+{
+class FrozenParser;
+/**
+ * The outcome of one parse: which flags are given, the value of every flag
+ * and the command path.
+ *
+ * A ParseResult is reused across parses of the same FrozenParser: only the
+ * flags set by the previous parse are reset. It must not outlive the parser
+ * it was filled by.
+ */
+class ParseResult
+{
+public:
+    ParseResult() = default;
+
+    std::vector<std::string> command_path() const;
+    /**
+     * Whether @name is a flag of the parsed command or a global flag.
+     */
+    bool has(std::string_view name) const;
+    /**
+     * The value of @name, given or default. Unlike ParserStore::get, this
+     * works for typed flags as well.
+     */
+    const flag::AllocatedFlag &get(std::string_view name) const;
+
+private:
+    friend class FrozenParser;
+    uint32_t find(std::string_view name) const;
+
+    const FrozenParser *parser_{nullptr};
+    flag::Bitset applied_;
+    // one per flag of the parser, indexed by the id of the flag
+    std::vector<flag::AllocatedFlag> values_;
+    std::vector<uint32_t> path_;
+    // flags applied by the last parse, to be reset
+    std::vector<uint32_t> dirty_;
+    // the internal result of FrozenParser::parse(argc, argv): the typed
+    // flags are written as they are applied
+    bool write_typed_{false};
+};
+
+/**
+ * An immutable, compact form of a whole Parser tree, built by
+ * Parser::freeze().
+ *
+ * The commands and flags of all levels are laid out in two flat arrays and
+ * their names are interned into one buffer. One hash index maps
+ * (command, name) to either a child command or a flag, so parsing never
+ * walks the tree of Parsers. Build the tree once, freeze it and parse many
+ * times.
+ *
+ * parse(argc, argv, result) is const: it only writes to @result, so one
+ * FrozenParser serves any number of concurrent parses, each with its own
+ * ParseResult. It never writes the variables bound by typed flags.
+ * parse(argc, argv) keeps the behaviour of Parser::parse: it fills an
+ * internal result and writes the typed flags.
+ */
+class FrozenParser
+{
+public:
+    using Id = uint32_t;
+    using FlagIndex = flag::FlagIndex;
+
+    FrozenParser() = default;
+    FrozenParser(const FrozenParser &) = delete;
+    FrozenParser(FrozenParser &&) = default;
+    FrozenParser &operator=(const FrozenParser &) = delete;
+    FrozenParser &operator=(FrozenParser &&) = default;
+
+    bool parse(int argc, const char *argv[], ParseResult &result) const
+    {
+        prepare(result);
+        auto tokens = tokenize(argc, argv);
+        Id command = kRoot;
+        for (const auto &[key, value] : tokens)
+        {
+            if (!flag::is_flag(key))
+            {
+                if (!enter_command(result, command, key))
+                {
+                    return false;
+                }
+                continue;
+            }
+            bool value_used = true;
+            if (!apply_flag(result, command, key, value, value_used))
+            {
+                std::cerr << "Failed to apply " << key << "=\"" << value
+                          << "\": Failure due to previous problem" << std::endl;
+                return false;
+            }
+            // the bundle took its value from within, e.g. -T8 start
+            if (!value_used && !value.empty())
+            {
+                if (is_attached(key, value))
+                {
+                    std::cerr << "Failed to apply " << key << "=\"" << value
+                              << "\": the bundle takes no value" << std::endl;
+                    return false;
+                }
+                if (!enter_command(result, command, value))
+                {
+                    return false;
+                }
+            }
+        }
+        return check_required(result, command) &&
+               check_groups(result, command);
+    }
+    /**
+     * Parse into @config: every flag bound to a member of C in the scope of
+     * the parsed command is written with its given or default value. The
+     * global flags are written first and the deepest command last. Flags
+     * bound to other types, or of commands not entered, are ignored.
+     */
+    template <typename C>
+    bool parse(int argc,
+               const char *argv[],
+               C &config,
+               ParseResult &result) const
+    {
+        if (!parse(argc, argv, result))
+        {
+            return false;
+        }
+        const auto *members = members_of(flag::MemberFlagBase<C>::class_tag());
+        if (members == nullptr)
+        {
+            return true;
+        }
+        auto apply_members = [&](Id first, Id end) {
+            auto it = std::lower_bound(members->begin(), members->end(), first);
+            for (; it != members->end() && *it < end; ++it)
+            {
+                auto id = *it;
+                if (!result.applied_.test(id) &&
+                    flags_[id].default_val == kNone)
+                {
+                    continue;
+                }
+                // the class is checked by members_of()
+                auto member = static_cast<const flag::MemberFlagBase<C> *>(
+                    flags_[id].typed.member());
+                if (!member->apply_to(config, result.values_[id].inner()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!apply_members(first_global_flag_, flags_.size()))
+        {
+            return false;
+        }
+        auto apply_command = [&](Id command) {
+            const auto &cmd = commands_[command];
+            return apply_members(cmd.first_flag,
+                                 cmd.first_flag + cmd.nr_flags);
+        };
+        if (!apply_command(kRoot))
+        {
+            return false;
+        }
+        for (auto command : result.path_)
+        {
+            if (!apply_command(command))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    template <typename C>
+    bool parse(int argc, const char *argv[], C &config) const
+    {
+        ParseResult result;
+        return parse(argc, argv, config, result);
+    }
+    bool parse(int argc, const char *argv[])
+    {
+        // restore the typed flags written by the last parse
+        for (auto id : result_.dirty_)
+        {
+            const auto &record = flags_[id];
+            if (record.default_val != kNone)
+            {
+                write(record, defaults_[record.default_val]);
+            }
+        }
+        result_.write_typed_ = true;
+        bool succ = parse(argc, argv, result_);
+        if (!defaults_written_)
+        {
+            // the defaults are not written at registration
+            for (Id id = 0; id < flags_.size(); ++id)
+            {
+                const auto &record = flags_[id];
+                if (!result_.applied_.test(id) && record.default_val != kNone)
+                {
+                    write(record, defaults_[record.default_val]);
+                }
+            }
+            defaults_written_ = true;
+        }
+        return succ;
+    }
+    std::vector<std::string> command_path() const
+    {
+        return result_.command_path();
+    }
+    bool has(std::string_view name) const
+    {
+        return result_.has(name);
+    }
+    const flag::AllocatedFlag &get(std::string_view name) const
+    {
+        return result_.get(name);
+    }
+    size_t command_nr() const
+    {
+        return commands_.size();
+    }
+    size_t flag_nr() const
+    {
+        return flags_.size();
+    }
+
+private:
+    friend class Parser;
+    friend class ParseResult;
+    constexpr static Id kRoot = 0;
+    constexpr static Id kNone = FlagIndex::kNotFound;
+    // the scope of the child commands of command c is (c | kCommandScope).
+    constexpr static FlagIndex::Scope kCommandScope = 1u << 31;
+    constexpr static FlagIndex::Scope kGlobalScope = kCommandScope - 1;
+
+    struct Name
+    {
+        uint32_t offset{0};
+        uint32_t length{0};
+    };
+    struct Command
+    {
+        Name name;
+        // the flags of the command are flags_[first_flag, +nr_flags)
+        Id first_flag{0};
+        Id nr_flags{0};
+        // its groups are groups_[first_group, +nr_groups)
+        Id first_group{0};
+        Id nr_groups{0};
+    };
+    struct FlagRecord
+    {
+        // the target of the typed flag, empty for a stored flag
+        flag::TypedSlot typed;
+        // the flag defined by ARGPARSER_DEFINE_FLAG, or nullptr
+        const registry::FlagDescriptor *descriptor{nullptr};
+        // the index to defaults_, if the flag has a default value
+        Id default_val{kNone};
+        Name full_name;
+        Name short_name;
+    };
+
+    std::string_view name_of(Name name) const
+    {
+        return std::string_view(names_.data() + name.offset, name.length);
+    }
+    Name intern(std::string_view name)
+    {
+        Name ret{static_cast<uint32_t>(names_.size()),
+                 static_cast<uint32_t>(name.size())};
+        names_.append(name.data(), name.size());
+        return ret;
+    }
+
+    Id add_command(const Parser &parser, std::string_view name)
+    {
+        Id id = commands_.size();
+        commands_.emplace_back();
+        commands_[id].name = intern(name);
+        commands_[id].first_flag = flags_.size();
+        commands_[id].first_group = groups_.size();
+        add_flags(*parser.flag_store_, id);
+        for (const auto &set : parser.flag_sets_)
+        {
+            add_flags(*set->store_, id);
+        }
+        commands_[id].nr_flags = flags_.size() - commands_[id].first_flag;
+        commands_[id].nr_groups = groups_.size() - commands_[id].first_group;
+        parser.for_each_command(
+            [&](std::string_view command, const Parser &sub_parser) {
+                Id child = add_command(sub_parser, command);
+                index_.insert(command, child, id | kCommandScope);
+            });
+        return id;
+    }
+    /**
+     * Add the flags of @store in the order of their ids, so that the flag
+     * with id i in @store is flags_[first + i] and the groups of @store
+     * carry over by shifting their bits.
+     */
+    void add_flags(const flag::FlagStore &store, FlagIndex::Scope scope)
+    {
+        using flag::FlagStore;
+        auto default_of = [](const std::optional<std::pmr::string> &value) {
+            return value.has_value()
+                       ? std::optional<std::string_view>(value.value())
+                       : std::nullopt;
+        };
+        Id first = flags_.size();
+        for (size_t i = 0; i < store.slots_.size(); ++i)
+        {
+            auto slot = store.slots_[i];
+            FlagRecord record;
+            std::string_view full_name, short_name;
+            std::optional<std::string_view> default_val;
+            if (slot & FlagStore::kAllocatedSlot)
+            {
+                slot &= ~FlagStore::kAllocatedSlot;
+                const auto &info = store.allocated_infos_[slot];
+                full_name = info.full_name;
+                short_name = info.short_name;
+                default_val = default_of(info.default_val);
+            }
+            else if (slot & FlagStore::kStaticSlot)
+            {
+                const auto *descriptor =
+                    store.static_flags_[slot & ~FlagStore::kStaticSlot];
+                record.descriptor = descriptor;
+                full_name = descriptor->full_name;
+                short_name = descriptor->short_name;
+                if (descriptor->default_val != nullptr)
+                {
+                    default_val = descriptor->default_val;
+                }
+            }
+            else
+            {
+                const auto &info = store.target_infos_[slot];
+                record.typed = store.targets_[slot];
+                if (record.typed.member() != nullptr)
+                {
+                    add_member(record.typed.member()->member_class(),
+                               flags_.size());
+                }
+                full_name = info.full_name;
+                short_name = info.short_name;
+                default_val = default_of(info.default_val);
+            }
+            add_flag(record,
+                     full_name,
+                     short_name,
+                     store.required_.test(i),
+                     default_val,
+                     scope);
+        }
+        for (const auto &group : store.groups_)
+        {
+            flag::FlagGroup shifted{group.kind, flag::Bitset()};
+            group.mask.for_each([&](size_t i) { shifted.mask.set(first + i); });
+            groups_.push_back(std::move(shifted));
+        }
+    }
+    /**
+     * The ids only grow, so every list of member_classes_ stays sorted.
+     */
+    void add_member(const void *member_class, Id id)
+    {
+        for (auto &[tag, ids] : member_classes_)
+        {
+            if (tag == member_class)
+            {
+                ids.push_back(id);
+                return;
+            }
+        }
+        member_classes_.emplace_back(member_class, std::vector<Id>{id});
+    }
+    /**
+     * The sorted ids of the flags bound to members of the class of @tag,
+     * or nullptr.
+     */
+    const std::vector<Id> *members_of(const void *tag) const
+    {
+        for (const auto &member_class : member_classes_)
+        {
+            if (member_class.first == tag)
+            {
+                return &member_class.second;
+            }
+        }
+        return nullptr;
+    }
+    /**
+     * Write @value to the variable bound to @record, if any. Fail if @value
+     * is not parsable.
+     */
+    static bool write(const FlagRecord &record, std::string_view value)
+    {
+        if (!record.typed.empty())
+        {
+            return record.typed.apply(value);
+        }
+        if (record.descriptor != nullptr)
+        {
+            return record.descriptor->apply(record.descriptor->slot, value);
+        }
+        return true;
+    }
+    void add_flag(FlagRecord &record,
+                  std::string_view full_name,
+                  std::string_view short_name,
+                  bool required,
+                  std::optional<std::string_view> default_val,
+                  FlagIndex::Scope scope)
+    {
+        Id id = flags_.size();
+        if (required)
+        {
+            required_.set(id);
+        }
+        record.full_name = intern(full_name);
+        record.short_name = intern(short_name);
+        prototypes_.emplace_back();
+        if (default_val.has_value())
+        {
+            record.default_val = defaults_.size();
+            defaults_.emplace_back(default_val.value());
+            prototypes_.back().apply(default_val.value());
+        }
+        flags_.push_back(record);
+        index_.insert(full_name, id, scope);
+        index_.insert(short_name, id, scope);
+        auto letter = flag::short_slot(short_name);
+        if (letter != flag::kNoShortSlot)
+        {
+            auto base = short_base(scope);
+            if (short_ids_.size() < base + flag::kNrShortSlots)
+            {
+                short_ids_.resize(base + flag::kNrShortSlots, kNone);
+            }
+            short_ids_[base + letter] = id;
+        }
+    }
+    /**
+     * The offset of the short table of @scope in short_ids_. The global
+     * flags are added last, so their table comes after all the commands.
+     */
+    size_t short_base(FlagIndex::Scope scope) const
+    {
+        size_t table = scope == kGlobalScope ? commands_.size() : scope;
+        return table * flag::kNrShortSlots;
+    }
+    Id find_short(std::string_view name, FlagIndex::Scope scope) const
+    {
+        auto letter = flag::short_slot(name);
+        auto at = short_base(scope) + letter;
+        return at < short_ids_.size() ? short_ids_[at] : kNone;
+    }
+    /**
+     * The flag @name of @command, or else the global flag @name. The
+     * one-letter short names are read from the direct tables.
+     */
+    Id find_flag(std::string_view name, Id command) const
+    {
+        if (flag::short_slot(name) != flag::kNoShortSlot)
+        {
+            auto id = find_short(name, command);
+            return id != kNone ? id : find_short(name, kGlobalScope);
+        }
+        auto id = index_.find(name, command);
+        return id != kNone ? id : index_.find(name, kGlobalScope);
+    }
+    /**
+     * Whether the flag takes no value in a bundle of short flags.
+     */
+    static bool is_switch(const FlagRecord &record)
+    {
+        if (record.descriptor != nullptr)
+        {
+            return record.descriptor->apply == &registry::apply_slot<bool>;
+        }
+        return record.typed.is_switch();
+    }
+    bool enter_command(ParseResult &result,
+                       Id &command,
+                       std::string_view name) const
+    {
+        auto child = index_.find(name, command | kCommandScope);
+        if (child == FlagIndex::kNotFound)
+        {
+            std::cerr << "Failed to parse command \"" << name
+                      << "\": use --help for usage." << std::endl;
+            return false;
+        }
+        command = child;
+        result.path_.push_back(command);
+        return true;
+    }
+    /**
+     * Apply the flag @key, or the bundle of short flags it stands for when
+     * no flag has that name. @value_used is set to whether @value went to
+     * a flag.
+     */
+    bool apply_flag(ParseResult &result,
+                    Id command,
+                    std::string_view key,
+                    std::string_view value,
+                    bool &value_used) const
+    {
+        value_used = true;
+        auto id = find_flag(key, command);
+        if (id != kNone || !flag::is_short_bundle(key))
+        {
+            return id != kNone && apply(result, id, key, value);
+        }
+        return apply_short_bundle(
+            key,
+            value,
+            value_used,
+            [&](std::string_view name) {
+                auto id = find_flag(name, command);
+                return id != kNone && is_switch(flags_[id]);
+            },
+            [&](std::string_view name, std::string_view v) {
+                auto id = find_flag(name, command);
+                return id != kNone && apply(result, id, name, v);
+            });
+    }
+
+    /**
+     * Make @result ready for a new parse. Only the flags applied by the last
+     * parse are reset.
+     */
+    void prepare(ParseResult &result) const
+    {
+        if (result.parser_ != this)
+        {
+            result.parser_ = this;
+            result.applied_.reserve(flags_.size());
+            result.applied_.clear();
+            result.values_ = prototypes_;
+            result.dirty_.clear();
+        }
+        for (auto id : result.dirty_)
+        {
+            result.applied_.reset(id);
+            result.values_[id].apply(prototypes_[id].inner());
+        }
+        result.dirty_.clear();
+        result.path_.clear();
+    }
+    bool apply(ParseResult &result,
+               Id id,
+               std::string_view key,
+               std::string_view value) const
+    {
+        const auto &record = flags_[id];
+        if (result.applied_.test(id))
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value << "\": "
+                      << "Flag " << key
+                      << " already set and is provided more than once."
+                      << std::endl;
+            return false;
+        }
+        bool parsable = true;
+        if (result.write_typed_)
+        {
+            // converted once, to check and to write
+            parsable = write(record, value);
+        }
+        else if (!record.typed.empty())
+        {
+            parsable = record.typed.parsable(value);
+        }
+        else if (record.descriptor != nullptr)
+        {
+            parsable = record.descriptor->parsable(value);
+        }
+        if (!parsable)
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value
+                      << "\": \"" << value << "\" not parsable";
+            auto suggestion = record.typed.suggest(value);
+            if (!suggestion.empty())
+            {
+                std::cerr << ", did you mean \"" << suggestion << "\"?";
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+        result.values_[id].apply(value);
+        result.applied_.set(id);
+        result.dirty_.push_back(id);
+        return true;
+    }
+    /**
+     * One masked compare per 64 flags of @command. The missing flags are
+     * only listed on failure.
+     */
+    bool check_required(const ParseResult &result, Id command) const
+    {
+        const auto &cmd = commands_[command];
+        Id end = cmd.first_flag + cmd.nr_flags;
+        if (result.applied_.contains(required_, cmd.first_flag, end))
+        {
+            return true;
+        }
+        std::cerr << "Failed to parse command line: [";
+        for (Id id = cmd.first_flag; id < end; ++id)
+        {
+            if (!required_.test(id) || result.applied_.test(id))
+            {
+                continue;
+            }
+            const auto &record = flags_[id];
+            std::cerr << "{Flag " << name_of(record.full_name) << ", "
+                      << name_of(record.short_name) << "}, ";
+        }
+        std::cerr << "] are required but not provided." << std::endl;
+        return false;
+    }
+    bool check_groups(const ParseResult &result, Id command) const
+    {
+        const auto &cmd = commands_[command];
+        for (Id i = cmd.first_group; i < cmd.first_group + cmd.nr_groups; ++i)
+        {
+            const auto &group = groups_[i];
+            if (group.satisfied(result.applied_))
+            {
+                continue;
+            }
+            std::cerr << "Failed to parse command line: flags [";
+            group.mask.for_each([this](size_t id) {
+                const auto &record = flags_[id];
+                auto full_name = name_of(record.full_name);
+                std::cerr << (full_name.empty() ? name_of(record.short_name)
+                                                : full_name)
+                          << ", ";
+            });
+            std::cerr << "] " << group.describe() << "." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<Command> commands_;
+    std::vector<FlagRecord> flags_;
+    std::vector<std::string> defaults_;
+    // the value of every flag before parsing, copied into a new ParseResult
+    std::vector<flag::AllocatedFlag> prototypes_;
+    flag::Bitset required_;
+    std::vector<flag::FlagGroup> groups_;
+    std::string names_;
+    FlagIndex index_;
+    // kNrShortSlots ids per command, then for the global flags
+    std::vector<Id> short_ids_;
+    // the typed flags bound to a member rather than a variable, by the
+    // class tag of MemberFlagBase
+    std::vector<std::pair<const void *, std::vector<Id>>> member_classes_;
+    // the global flags are flags_[first_global_flag_, end)
+    Id first_global_flag_{0};
+
+    // the result of parse(argc, argv)
+    ParseResult result_;
+    // whether parse(argc, argv) wrote the defaults of the typed flags
+    bool defaults_written_{false};
+};
+
+inline std::vector<std::string> ParseResult::command_path() const
+{
+    std::vector<std::string> ret;
+    ret.reserve(path_.size());
+    for (auto id : path_)
+    {
+        ret.emplace_back(parser_->name_of(parser_->commands_[id].name));
+    }
+    return ret;
+}
+inline uint32_t ParseResult::find(std::string_view name) const
+{
+    if (parser_ == nullptr)
+    {
+        return FrozenParser::kNone;
+    }
+    auto command = path_.empty() ? FrozenParser::kRoot : path_.back();
+    return parser_->find_flag(name, command);
+}
+inline bool ParseResult::has(std::string_view name) const
+{
+    return find(name) != FrozenParser::kNone;
+}
+inline const flag::AllocatedFlag &ParseResult::get(std::string_view name) const
+{
+    auto id = find(name);
+    if (id == FrozenParser::kNone)
+    {
+        std::cerr << "Failed to get " << name << ": not found." << std::endl;
+        std::terminate();
+    }
+    return values_[id];
+}
+
+inline FrozenParser Parser::freeze() const
+{
+    FrozenParser frozen;
+    frozen.add_command(*this, "");
+    frozen.first_global_flag_ = frozen.flags_.size();
+    frozen.add_flags(*gf_store_, FrozenParser::kGlobalScope);
+    return frozen;
+}
+
+}  // namespace argparser
+#endif
@@ -0,0 +1,101 @@
+#ifndef ARG_PARSER_HELP_FORMATTER_H
+#define ARG_PARSER_HELP_FORMATTER_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace argparser
+{
+/**
+ * Lays out the help message into one contiguous buffer.
+ *
+ * Every piece of text is appended exactly once and wrapping is decided while
+ * scanning the words, so the rendering is linear in the size of the output.
+ * The caller writes the buffer out with a single call.
+ */
+class HelpFormatter
+{
+public:
+    HelpFormatter() = default;
+
+    HelpFormatter &append(std::string_view text)
+    {
+        buffer_.append(text.data(), text.size());
+        return *this;
+    }
+    HelpFormatter &pad(size_t nr)
+    {
+        buffer_.append(nr, ' ');
+        return *this;
+    }
+    HelpFormatter &line(std::string_view text = {})
+    {
+        append(text);
+        buffer_.push_back('\n');
+        return *this;
+    }
+    /**
+     * Append @text word by word, assuming the cursor is already at column
+     * @indent. A line is broken before a word that would make it longer than
+     * @width, and the next line is indented by @indent spaces again.
+     * The text always ends with a new line.
+     */
+    HelpFormatter &wrap(std::string_view text, size_t indent, size_t width)
+    {
+        size_t line_len = 0;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            if (text[pos] == ' ')
+            {
+                pos++;
+                continue;
+            }
+            size_t end = text.find(' ', pos);
+            if (end == std::string_view::npos)
+            {
+                end = text.size();
+            }
+            size_t word_len = end - pos;
+            if (line_len != 0 && line_len + 1 + word_len > width)
+            {
+                buffer_.push_back('\n');
+                pad(indent);
+                line_len = 0;
+            }
+            if (line_len != 0)
+            {
+                buffer_.push_back(' ');
+                line_len++;
+            }
+            buffer_.append(text.data() + pos, word_len);
+            line_len += word_len;
+            pos = end;
+        }
+        buffer_.push_back('\n');
+        return *this;
+    }
+    void reserve(size_t size)
+    {
+        buffer_.reserve(size);
+    }
+    const std::string &str() const
+    {
+        return buffer_;
+    }
+    /**
+     * Emit the whole buffer with one write.
+     */
+    void write_to(std::ostream &os) const
+    {
+        os.write(buffer_.data(), buffer_.size());
+        os.flush();
+    }
+
+private:
+    std::string buffer_;
+};
+
+}  // namespace argparser
+#endif
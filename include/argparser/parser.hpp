@@ -1,22 +1,30 @@
 #ifndef ARG_PARSER_H
 #define ARG_PARSER_H
 #include <cctype>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
-#include <list>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <set>
 #include <sstream>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "./common.hpp"
 #include "./debug.hpp"
+#include "./flag-registry.hpp"
+#include "./flag-set.hpp"
 #include "./flag-store.hpp"
 #include "./flag-validator.hpp"
+#include "./help-formatter.hpp"
+#include "./radix-tree.hpp"
+#include "./tokenizer.hpp"
 namespace argparser
 {
 class Parser;
+class FrozenParser;
 class ParserStore
 {
 public:
@@ -27,48 +35,77 @@ public:
     ParserStore(ParserStore &&) = delete;
     ParserStore &operator=(const ParserStore &) = delete;
     ParserStore &operator=(ParserStore &&) = delete;
-    const flag::AllocatedFlag &get(const std::string &name) const
+    const flag::AllocatedFlag &get(std::string_view name) const
     {
-        if (flag_store_->has(name))
+        if (const auto *flag = get_if(name))
         {
-            return flag_store_->get(name);
+            return *flag;
         }
         return gf_store_->get(name);
     }
-    bool has(const std::string &name) const
+    bool has(std::string_view name) const
     {
-        return flag_store_->has(name) || gf_store_->has(name);
+        return get_if(name) != nullptr || gf_store_->has(name);
     }
 
 private:
     friend Parser;
-    void link_flag_store(flag::FlagStore::Pointer p)
+    // the stored flag @name of the command or of its flag sets
+    const flag::AllocatedFlag *get_if(std::string_view name) const
+    {
+        if (const auto *flag = flag_store_->get_if(name))
+        {
+            return flag;
+        }
+        for (const auto &set : *flag_sets_)
+        {
+            if (const auto *flag = set->store_->get_if(name))
+            {
+                return flag;
+            }
+        }
+        return nullptr;
+    }
+    void link_flag_store(flag::FlagStore::Pointer p,
+                         const std::pmr::vector<FlagSet::Pointer> *flag_sets)
     {
         flag_store_ = p;
+        flag_sets_ = flag_sets;
     }
     void link_global_flag_store(flag::FlagStore::Pointer p)
     {
         gf_store_ = p;
     }
     flag::FlagStore::Pointer flag_store_;
+    const std::pmr::vector<FlagSet::Pointer> *flag_sets_{nullptr};
     flag::FlagStore::Pointer gf_store_;
 };
 class Parser
 {
 public:
     using Pointer = std::unique_ptr<Parser>;
-    using FlagPair = std::pair<std::string, std::string>;
-    using FlagPairs = std::list<FlagPair>;
+    /**
+     * Every allocation of the parser, its sub-parsers and flags, and of
+     * parse() is served by @mr, which must outlive the parser.
+     */
     Parser(std::shared_ptr<flag::FlagStore> global_flag_store,
-           const char *description)
-        : description_(description),
-          flag_store_(flag::FlagStore::new_instance()),
+           const char *description,
+           std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : mr_(mr),
+          program_name(mr),
+          description_(description, mr),
+          flag_store_(flag::FlagStore::new_instance(mr)),
           gf_store_(global_flag_store),
-          validator_(gf_store_),
-          store_(std::make_unique<ParserStore>())
+          flag_sets_(mr),
+          sub_parsers_(mr),
+          lazy_commands_(mr),
+          names_(mr),
+          nr_named_set_flags_(mr),
+          validator_(flag_store_, gf_store_),
+          command_path_(mr)
     {
-        store_->link_global_flag_store(gf_store_);
-        store_->link_flag_store(flag_store_);
+        store_.link_global_flag_store(gf_store_);
+        store_.link_flag_store(flag_store_, &flag_sets_);
     }
     Parser(const Parser &) = delete;
     Parser(Parser &&) = delete;
@@ -82,28 +119,120 @@ public:
             std::cerr << "ERR: parse() not called." << std::endl;
             return;
         }
-        std::cout << description_ << std::endl << std::endl;
-
-        print_usage();
-        print_command();
-        flag_store_->print_flags();
-        gf_store_->print_flags("Global Flag");
+        HelpFormatter formatter;
+        format_promt(formatter);
+        formatter.write_to(std::cout);
+    }
+    /**
+     * Render the help message, as printed by print_promt(), to a string.
+     */
+    std::string help() const
+    {
+        HelpFormatter formatter;
+        format_promt(formatter);
+        return formatter.str();
     }
     void print_promt(int argc, const char *argv[]) const
     {
-        auto pairs = retrieve(argc, argv);
-        return print_promt(pairs);
+        auto tokens = tokenize(argc, argv, mr_);
+        return print_promt(tokens, 0);
     }
-    std::string desc() const
+    const std::pmr::string &desc() const
     {
         return description_;
     }
-    Parser &command(const std::string &command, const char *desc = "")
+    Parser &command(std::string_view command, const char *desc = "")
+    {
+        if (auto *existing = sub_parser(names_.find(command)))
+        {
+            return *existing;
+        }
+        auto sub = std::allocate_shared<Parser>(
+            std::pmr::polymorphic_allocator<Parser>(mr_), gf_store_, desc, mr_);
+        sub->allow_prefix_ = allow_prefix_;
+        sub->validate_defaults(validate_defaults_);
+        sub->lazy_ = lazy_;
+        sub->parent_ = this;
+        names_.insert(command, sub_parsers_.size());
+        sub_parsers_.push_back(std::move(sub));
+        max_command_len_ = std::max(max_command_len_, command.size());
+        return *sub_parsers_.back();
+    }
+    using Factory = std::function<void(Parser &)>;
+    /**
+     * Define the command @command without building its sub-parser. The
+     * sub-parser is built, and @factory registers its flags and commands,
+     * only once a parse enters the command, its help is printed or the
+     * tree is frozen. Until then the command costs its name, @desc and
+     * @factory, and the variables of its flags are not written.
+     *
+     * A global flag must exist before the parse reaches it, so the
+     * factory, and the commands it defines, cannot register any: their
+     * global_flag() fails.
+     *
+     * Return false if @command is already defined.
+     */
+    bool command(std::string_view command, const char *desc, Factory factory)
     {
-        sub_parsers_.emplace(command,
-                             std::make_unique<Parser>(gf_store_, desc));
+        auto slot = kLazySlot | static_cast<uint32_t>(lazy_commands_.size());
+        if (!names_.insert(command, slot))
+        {
+            std::cerr << "Failed to define command \"" << command
+                      << "\": already defined" << std::endl;
+            return false;
+        }
+        lazy_commands_.push_back(
+            LazyCommand{std::pmr::string(desc, mr_), std::move(factory)});
         max_command_len_ = std::max(max_command_len_, command.size());
-        return *sub_parsers_[command];
+        return true;
+    }
+    /**
+     * Accept a unique prefix of a command or of a long flag for its whole
+     * name, e.g. spin for spin-lock or --thr for --threads. It holds for
+     * this parser and its commands, present and future. Global flags are
+     * matched by their whole names only.
+     */
+    void allow_prefix(bool allow = true)
+    {
+        allow_prefix_ = allow;
+        for (auto &sub_parser : sub_parsers_)
+        {
+            sub_parser->allow_prefix(allow);
+        }
+    }
+    /**
+     * Report a malformed default when its flag is registered, rather than
+     * when a parse leaves the flag unapplied. On by default; turn it off to
+     * convert only the defaults a parse needs. It holds for the flags
+     * registered afterwards, in this parser, its commands, the global flags
+     * and the flag sets used here, now or later.
+     */
+    void validate_defaults(bool validate = true)
+    {
+        validate_defaults_ = validate;
+        flag_store_->validate_defaults(validate);
+        gf_store_->validate_defaults(validate);
+        for (auto &sub_parser : sub_parsers_)
+        {
+            sub_parser->validate_defaults(validate);
+        }
+        for (auto &set : flag_sets_)
+        {
+            set->validate_defaults(validate);
+        }
+    }
+    /**
+     * The commands and long flags of this parser starting with @prefix, in
+     * order, e.g. for shell completion.
+     */
+    std::vector<std::string> complete(std::string_view prefix) const
+    {
+        sync_flag_names();
+        std::vector<std::string> ret;
+        names_.for_each(prefix, [&ret](std::string_view name, uint32_t) {
+            ret.emplace_back(name);
+        });
+        return ret;
     }
     // TODO: make default has type?
     template <typename T>
@@ -113,7 +242,7 @@ public:
               const char *desc,
               const char *default_val)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate(full_name, short_name))
         {
             return false;
         }
@@ -126,13 +255,44 @@ public:
               const char *short_name,
               const char *desc)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate(full_name, short_name))
         {
             return false;
         }
         return flag_store_->add_flag(
             flag, full_name, short_name, desc, std::nullopt, true);
     }
+    /**
+     * Bind the flag to a member of C, e.g. flag(&Config::threads, ...).
+     * Any instance of C is filled by FrozenParser::parse(argc, argv, config).
+     */
+    template <typename C, typename T>
+    bool flag(T C::*member,
+              const char *full_name,
+              const char *short_name,
+              const char *desc,
+              const char *default_val)
+    {
+        if (!validate(full_name, short_name))
+        {
+            return false;
+        }
+        return flag_store_->add_flag(
+            member, full_name, short_name, desc, default_val, false);
+    }
+    template <typename C, typename T>
+    bool flag(T C::*member,
+              const char *full_name,
+              const char *short_name,
+              const char *desc)
+    {
+        if (!validate(full_name, short_name))
+        {
+            return false;
+        }
+        return flag_store_->add_flag(
+            member, full_name, short_name, desc, std::nullopt, true);
+    }
     /**
      * This function register flag to the internal FlagStore.
      * The user can later retrieve the flag via
@@ -140,7 +300,7 @@ public:
      */
     bool flag(const char *full_name, const char *short_name, const char *desc)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate(full_name, short_name))
         {
             return false;
         }
@@ -152,7 +312,7 @@ public:
               const char *desc,
               const char *default_val)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate(full_name, short_name))
         {
             return false;
         }
@@ -165,7 +325,7 @@ public:
                      const char *short_name,
                      const char *desc)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate_global(full_name, short_name))
         {
             return false;
         }
@@ -179,7 +339,7 @@ public:
                      const char *desc,
                      const char *default_val)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate_global(full_name, short_name))
         {
             return false;
         }
@@ -195,7 +355,7 @@ public:
                      const char *short_name,
                      const char *desc)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate_global(full_name, short_name))
         {
             return false;
         }
@@ -207,7 +367,7 @@ public:
                      const char *desc,
                      const char *default_val)
     {
-        if (!validator_.validate(full_name, short_name))
+        if (!validate_global(full_name, short_name))
         {
             return false;
         }
@@ -218,61 +378,403 @@ public:
     {
         command_path_.clear();
         program_name = argv[0];
+        gf_store_->reset();
+        reset_flag_sets();
 
-        auto pairs = retrieve(argc, argv);
-        return do_parse(pairs, store_, command_path_);
+        auto tokens = tokenize(argc, argv, mr_);
+        bool succ = do_parse(tokens, 0, store_, command_path_);
+        bool defaults = materialize_defaults();
+        defaults = gf_store_->materialize_defaults() && defaults;
+        return succ && defaults;
     }
     std::vector<std::string> command_path() const
     {
-        return command_path_;
+        std::vector<std::string> ret;
+        ret.reserve(command_path_.size());
+        for (const auto &command : command_path_)
+        {
+            ret.emplace_back(command);
+        }
+        return ret;
     }
     const ParserStore &store() const
     {
-        return *store_;
+        return store_;
     }
+    /**
+     * Register the flags @descriptors[0, @nr) at once, e.g. a table built
+     * by registry::describe(). All the names are checked in one hashed
+     * pass, the defaults only once every name passed, and the storage is
+     * reserved once. Either all the flags are registered or none is.
+     *
+     * As for the registry, the store refers to the descriptors, which must
+     * outlive the parser.
+     */
+    bool flags(const registry::FlagDescriptor *descriptors, size_t nr)
+    {
+        // the names of the batch, to find duplicates among them
+        flag::FlagIndex batch(mr_);
+        batch.reserve(2 * nr, registry::name_bytes(descriptors, nr));
+        for (size_t i = 0; i < nr; ++i)
+        {
+            std::string_view full_name = descriptors[i].full_name;
+            std::string_view short_name = descriptors[i].short_name;
+            if (!registry::valid_names(full_name, short_name))
+            {
+                std::cerr << "Failed to register flag " << full_name << ", "
+                          << short_name << ": identity not allowed"
+                          << std::endl;
+                return false;
+            }
+            if (flag_store_->contain(full_name) ||
+                flag_store_->contain(short_name) ||
+                in_flag_set(full_name) || in_flag_set(short_name) ||
+                (!full_name.empty() && !batch.insert(full_name, i)) ||
+                (!short_name.empty() && !batch.insert(short_name, i)))
+            {
+                std::cerr << "Failed to register flag " << full_name << ", "
+                          << short_name << ": flag already registered"
+                          << std::endl;
+                return false;
+            }
+            if (gf_store_->contain(full_name) || gf_store_->contain(short_name))
+            {
+                std::cerr << "Flag registered failed: flag \"" << full_name
+                          << "\", \"" << short_name
+                          << "\" conflict with global flag" << std::endl;
+                return false;
+            }
+        }
+        for (size_t i = 0; i < nr; ++i)
+        {
+            if (!flag_store_->check_default(descriptors[i]))
+            {
+                return false;
+            }
+        }
+        flag_store_->add_flags(descriptors, nr);
+        return true;
+    }
+    template <size_t N>
+    bool flags(const registry::FlagDescriptor (&descriptors)[N])
+    {
+        return flags(descriptors, N);
+    }
+    /**
+     * Register to this parser the flags defined by ARGPARSER_DEFINE_FLAG in
+     * any translation unit. The descriptors are walked in place, so this
+     * costs one index insertion per name and no copy of the flags.
+     */
+    bool load_registered_flags()
+    {
+        bool succ = true;
+        flag_store_->reserve(registry::nr_flags());
+        registry::for_each_flag([&](const registry::FlagDescriptor &d) {
+            std::string_view full_name = d.full_name;
+            std::string_view short_name = d.short_name;
+            if (flag_store_->contain(full_name) ||
+                flag_store_->contain(short_name) || in_flag_set(full_name) ||
+                in_flag_set(short_name))
+            {
+                std::cerr << "Failed to register flag " << full_name << ", "
+                          << short_name << ": flag already registered"
+                          << std::endl;
+                succ = false;
+                return;
+            }
+            if (gf_store_->contain(full_name) || gf_store_->contain(short_name))
+            {
+                std::cerr << "Flag registered failed: flag \"" << full_name
+                          << "\", \"" << short_name
+                          << "\" conflict with global flag" << std::endl;
+                succ = false;
+                return;
+            }
+            succ = flag_store_->add_flag(d) && succ;
+        });
+        return succ;
+    }
+    /**
+     * Constrain flags already registered to this parser: at most one of
+     * @names may be given, at least one must be, or all or none of them.
+     * Checked after the required flags, by a masked compare over the
+     * applied flags.
+     */
+    bool mutually_exclusive(std::initializer_list<std::string_view> names)
+    {
+        return flag_store_->add_group(flag::FlagGroup::Kind::kExclusive,
+                                      names);
+    }
+    bool at_least_one(std::initializer_list<std::string_view> names)
+    {
+        return flag_store_->add_group(flag::FlagGroup::Kind::kAtLeastOne,
+                                      names);
+    }
+    bool all_or_none(std::initializer_list<std::string_view> names)
+    {
+        return flag_store_->add_group(flag::FlagGroup::Kind::kAllOrNone,
+                                      names);
+    }
+    /**
+     * Use the flags of @set in this parser, as if registered to it. The
+     * flags are shared with every other parser using @set, and no flag is
+     * copied. Fail if a name of @set is already taken here. @set takes the
+     * validate_defaults() setting of this parser.
+     *
+     * The parse state of @set is shared as well, so a parse entering two
+     * commands using it would see the flags of one in the other. Fail if
+     * a command above or below this one uses @set.
+     */
+    bool use(const FlagSet::Pointer &set)
+    {
+        for (const auto *p = parent_; p != nullptr; p = p->parent_)
+        {
+            if (p->uses(*set))
+            {
+                std::cerr << "Failed to use flag set \"" << set->name()
+                          << "\": already used by an enclosing command"
+                          << std::endl;
+                return false;
+            }
+        }
+        if (below_uses(*set))
+        {
+            std::cerr << "Failed to use flag set \"" << set->name()
+                      << "\": already used by a sub-command" << std::endl;
+            return false;
+        }
+        const auto &store = *set->store_;
+        for (size_t id = 0; id < store.size(); ++id)
+        {
+            auto [full_name, short_name] = store.names_of(id);
+            if (store_of(full_name) != nullptr ||
+                store_of(short_name) != nullptr)
+            {
+                std::cerr << "Failed to use flag set \"" << set->name()
+                          << "\": flag " << full_name << ", " << short_name
+                          << " already registered" << std::endl;
+                return false;
+            }
+        }
+        set->validate_defaults(validate_defaults_);
+        flag_sets_.push_back(set);
+        return true;
+    }
+    /**
+     * Compile the whole tree of parsers into a FrozenParser.
+     * The typed flags keep writing into the registered variables.
+     */
+    FrozenParser freeze() const;
 
 private:
+    friend class FrozenParser;
     bool init_{false};
-    std::string program_name;
-    std::string description_;
+    bool allow_prefix_{false};
+    bool validate_defaults_{true};
+    // built by the factory of a lazy command, or under such a parser
+    bool lazy_{false};
+    // the parser this one is a command of, nullptr for the root
+    const Parser *parent_{nullptr};
+    std::pmr::memory_resource *mr_;
+    std::pmr::string program_name;
+    std::pmr::string description_;
 
     flag::FlagStore::Pointer flag_store_;
     flag::FlagStore::Pointer gf_store_;
-    std::unordered_map<std::string, Pointer> sub_parsers_;
+    // the flag sets used by this parser, see use()
+    std::pmr::vector<FlagSet::Pointer> flag_sets_;
+    // in the order of registration, named by names_; the lazy commands
+    // join once built, which a const method may do
+    mutable std::pmr::vector<std::shared_ptr<Parser>> sub_parsers_;
+    struct LazyCommand
+    {
+        std::pmr::string desc;
+        Factory factory;
+        // the index of the sub-parser in sub_parsers_, once built
+        uint32_t built{flag::RadixTree::kNotFound};
+    };
+    mutable std::pmr::vector<LazyCommand> lazy_commands_;
+    constexpr static flag::RadixTree::Slot kLazySlot = 1u << 30;
+    // the commands, to their index in sub_parsers_ or to kLazySlot plus
+    // their index in lazy_commands_, and the long flags
+    mutable flag::RadixTree names_;
+    // the flags of flag_store_, and of each of flag_sets_, already in
+    // names_; which store a flag belongs to is found by store_of()
+    mutable size_t nr_named_flags_{0};
+    mutable std::pmr::vector<size_t> nr_named_set_flags_;
     size_t max_command_len_{0};
 
     flag::Validator validator_;
 
-    std::vector<std::string> command_path_;
-    ParserStore::Pointer store_;
+    std::pmr::vector<std::pmr::string> command_path_;
+    ParserStore store_;
 
-    void print_usage() const
+    /**
+     * The store holding the flag @name in this parser: its own, that of a
+     * flag set it uses, or the global one. nullptr if there is none.
+     */
+    flag::FlagStore *store_of(std::string_view name) const
     {
-        if (!flag_store_->empty() || !sub_parsers_.empty())
+        if (flag_store_->contain(name))
         {
-            std::cout << "Usage:" << std::endl;
+            return flag_store_.get();
         }
-        if (!sub_parsers_.empty())
+        for (const auto &set : flag_sets_)
         {
-            std::cout << std::string(8, ' ') << program_name << " [command]"
-                      << std::endl;
+            if (set->store_->contain(name))
+            {
+                return set->store_.get();
+            }
+        }
+        if (gf_store_->contain(name))
+        {
+            return gf_store_.get();
+        }
+        return nullptr;
+    }
+    bool uses(const FlagSet &set) const
+    {
+        for (const auto &used : flag_sets_)
+        {
+            if (used.get() == &set)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    /**
+     * Whether a command under this parser uses @set. The lazy commands not
+     * built yet check it themselves, in use().
+     */
+    bool below_uses(const FlagSet &set) const
+    {
+        for (const auto &sub_parser : sub_parsers_)
+        {
+            if (sub_parser->uses(set) || sub_parser->below_uses(set))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool in_flag_set(std::string_view name) const
+    {
+        for (const auto &set : flag_sets_)
+        {
+            if (set->store_->contain(name))
+            {
+                return true;
+            }
         }
-        if (!flag_store_->empty())
-            std::cout << std::string(8, ' ') << program_name << " [flag]"
+        return false;
+    }
+    /**
+     * A global flag registered by the factory of a lazy command would not
+     * exist until the command is entered, after the parse went past it.
+     */
+    bool validate_global(std::string_view full_name,
+                         std::string_view short_name)
+    {
+        if (lazy_)
+        {
+            std::cerr << "Failed to register global flag " << full_name
+                      << ", " << short_name
+                      << ": not allowed within the factory of a command"
                       << std::endl;
-        if (!flag_store_->empty() || !sub_parsers_.empty())
+            return false;
+        }
+        return validate(full_name, short_name);
+    }
+    bool validate(std::string_view full_name, std::string_view short_name)
+    {
+        if (!validator_.validate(full_name, short_name))
+        {
+            return false;
+        }
+        for (const auto &set : flag_sets_)
+        {
+            if (set->store_->contain(full_name) ||
+                set->store_->contain(short_name))
+            {
+                std::cerr << "Failed to register flag " << full_name << ", "
+                          << short_name << ": flag already in flag set \""
+                          << set->name() << "\"" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * Forget the flags of the sets applied by the last parse. A set used by
+     * several parsers is reset once per parser.
+     */
+    void reset_flag_sets()
+    {
+        for (auto &set : flag_sets_)
+        {
+            set->store_->reset();
+        }
+        for (auto &sub_parser : sub_parsers_)
+        {
+            sub_parser->reset_flag_sets();
+        }
+    }
+    /**
+     * Write the defaults left unapplied in the stores of the whole tree.
+     * A store untouched since its last call costs one word compare.
+     */
+    bool materialize_defaults()
+    {
+        bool succ = flag_store_->materialize_defaults();
+        for (auto &set : flag_sets_)
+        {
+            succ = set->store_->materialize_defaults() && succ;
+        }
+        for (auto &sub_parser : sub_parsers_)
+        {
+            succ = sub_parser->materialize_defaults() && succ;
+        }
+        return succ;
+    }
+    void format_promt(HelpFormatter &formatter) const
+    {
+        formatter.line(description_).line();
+        format_usage(formatter);
+        format_command(formatter);
+        flag_store_->format_flags(formatter);
+        for (const auto &set : flag_sets_)
+        {
+            set->store_->format_flags(formatter, set->name());
+        }
+        gf_store_->format_flags(formatter, "Global Flag");
+    }
+    void format_usage(HelpFormatter &formatter) const
+    {
+        if (flag_store_->empty() && flag_sets_.empty() && !has_command())
+        {
+            return;
+        }
+        formatter.line("Usage:");
+        if (has_command())
+        {
+            formatter.pad(8).append(program_name).line(" [command]");
+        }
+        if (!flag_store_->empty() || !flag_sets_.empty())
         {
-            std::cout << std::endl;
+            formatter.pad(8).append(program_name).line(" [flag]");
         }
+        formatter.line();
     }
-    void print_promt(FlagPairs &pairs) const
+    void print_promt(const Tokens &tokens, size_t cursor) const
     {
-        for (auto it = pairs.begin(); it != pairs.end(); ++it)
+        for (; cursor < tokens.size(); ++cursor)
         {
-            const auto &key = it->first;
+            const auto &key = tokens[cursor].key;
             if (flag::is_flag(key))
             {
-                if (flag_store_->contain(key))
+                auto *store = store_of(key);
+                if (store != nullptr && store != gf_store_.get())
                 {
                     // this flag is expected, we can keep going.
                     continue;
@@ -286,13 +788,12 @@ private:
             else
             {
                 // this is a command
-                auto parser_it = sub_parsers_.find(key);
-                if (parser_it == sub_parsers_.end())
+                auto *sub = sub_parser(find_command(key).slot);
+                if (sub == nullptr)
                 {
                     break;
                 }
-                pairs.erase(pairs.begin(), ++it);
-                return parser_it->second->print_promt(pairs);
+                return sub->print_promt(tokens, cursor + 1);
             }
         }
         print_promt();
@@ -301,52 +802,227 @@ private:
     {
         return flag_store_;
     }
-    void print_command() const
+    constexpr static size_t kCommandDescWidth = 60;
+    void format_command(HelpFormatter &formatter) const
     {
-        if (!sub_parsers_.empty())
+        if (!has_command())
         {
-            std::cout << "Available Commands:" << std::endl;
-            for (const auto &[command, parser] : sub_parsers_)
+            return;
+        }
+        formatter.line("Available Commands:");
+        size_t indent = 2 + max_command_len_ + 2;
+        // the lazy commands are listed without being built
+        names_.for_each("", [&](std::string_view command, uint32_t slot) {
+            std::string_view desc;
+            if (slot < sub_parsers_.size())
             {
-                std::cout << "  " << command;
-                size_t printed_length = 2 + command.length();
-                std::cout << std::string(
-                    max_command_len_ + 2 + 2 - printed_length, ' ');
-                auto desc = parser->desc();
-
-                size_t pos = 0;
-                std::string token;
-                size_t current_column = 0;
-                while ((pos = desc.find(" ")) != std::string::npos)
-                {
-                    token = desc.substr(0, pos);
-                    current_column += token.size();
-                    if (current_column >= 60)
-                    {
-                        current_column = 0;
-                        std::cout << std::endl
-                                  << std::string(max_command_len_ + 2 + 2, ' ');
-                    }
-                    std::cout << token << " ";
-                    desc.erase(0, pos + 1);
-                }
-                std::cout << desc << std::endl;
-                // std::cout << parser->desc() << std::endl;
+                desc = sub_parsers_[slot]->desc();
+            }
+            else if (slot & kLazySlot)
+            {
+                desc = lazy_commands_[slot & ~kLazySlot].desc;
+            }
+            else
+            {
+                return;
+            }
+            formatter.pad(2).append(command).pad(indent - 2 - command.size());
+            formatter.wrap(desc, indent, kCommandDescWidth);
+        });
+        formatter.line();
+    }
+    bool has_command() const
+    {
+        return !sub_parsers_.empty() || !lazy_commands_.empty();
+    }
+    /**
+     * Call @f(name, sub_parser) with every command, in the order of the
+     * names. The lazy commands are built.
+     */
+    template <typename F>
+    void for_each_command(F &&f) const
+    {
+        names_.for_each("", [&](std::string_view name, uint32_t slot) {
+            if (auto *sub = sub_parser(slot))
+            {
+                f(name, *sub);
             }
-            std::cout << std::endl;
+        });
+    }
+    /**
+     * The sub-parser of the command of @slot in names_, built if lazy, or
+     * nullptr if @slot is not a command.
+     */
+    Parser *sub_parser(flag::RadixTree::Slot slot) const
+    {
+        if (slot < sub_parsers_.size())
+        {
+            return sub_parsers_[slot].get();
+        }
+        if (!(slot & kLazySlot) || slot == flag::RadixTree::kAmbiguous ||
+            slot == flag::RadixTree::kNotFound)
+        {
+            return nullptr;
+        }
+        auto &lazy = lazy_commands_[slot & ~kLazySlot];
+        if (lazy.built == flag::RadixTree::kNotFound)
+        {
+            auto sub = std::allocate_shared<Parser>(
+                std::pmr::polymorphic_allocator<Parser>(mr_),
+                gf_store_,
+                lazy.desc.c_str(),
+                mr_);
+            sub->allow_prefix_ = allow_prefix_;
+            sub->validate_defaults(validate_defaults_);
+            sub->lazy_ = true;
+            sub->parent_ = this;
+            lazy.built = sub_parsers_.size();
+            sub_parsers_.push_back(sub);
+            auto factory = std::move(lazy.factory);
+            lazy.factory = nullptr;
+            factory(*sub);
         }
+        return sub_parsers_[lazy.built].get();
     }
-    bool do_parse(FlagPairs &pairs,
-                  ParserStore::Pointer &store,
-                  std::vector<std::string> &command_path)
+    /**
+     * Delegate the tokens after @cursor to the sub_parser of @command.
+     */
+    bool parse_command(std::string_view command,
+                       const Tokens &tokens,
+                       size_t cursor,
+                       ParserStore &store,
+                       std::pmr::vector<std::pmr::string> &command_path)
+    {
+        auto [name, slot] = find_command(command);
+        if (slot == flag::RadixTree::kAmbiguous)
+        {
+            report_ambiguous(command);
+            return false;
+        }
+        auto *sub = sub_parser(slot);
+        if (sub == nullptr)
+        {
+            std::cerr << "Failed to parse command \"" << command
+                      << "\": use --help for usage.";
+            report_nearest(command);
+            std::cerr << std::endl;
+            return false;
+        }
+        command_path.emplace_back(name);
+        // pass the tokens after the command to the sub_parser
+        return sub->do_parse(tokens, cursor + 1, store, command_path);
+    }
+    /**
+     * Apply the flag @key, or the bundle of short flags it stands for when
+     * no flag has that name, e.g. -vxf or -T8. @value_used is set to
+     * whether @value went to a flag.
+     */
+    bool apply_flag(std::string_view key,
+                    std::string_view value,
+                    bool &value_used)
+    {
+        value_used = true;
+        if (auto *store = store_of(key))
+        {
+            return store->apply(key, value);
+        }
+        if (flag::is_short_bundle(key))
+        {
+            return apply_short_bundle(
+                key,
+                value,
+                value_used,
+                [this](std::string_view name) {
+                    auto *store = store_of(name);
+                    return store != nullptr && store->is_switch(name);
+                },
+                [this](std::string_view name, std::string_view v) {
+                    auto *store = store_of(name);
+                    return store != nullptr && store->apply(name, v);
+                });
+        }
+        if (allow_prefix_ && flag::is_full_flag(key))
+        {
+            sync_flag_names();
+            auto match = names_.complete(key);
+            if (match.slot == kFlagSlot)
+            {
+                return store_of(match.key)->apply(match.key, value);
+            }
+            if (match.slot == flag::RadixTree::kAmbiguous)
+            {
+                report_ambiguous(key);
+                return false;
+            }
+        }
+        std::cerr << "Unknown flag " << key << ".";
+        report_nearest(key);
+        std::cerr << std::endl;
+        return false;
+    }
+    constexpr static flag::RadixTree::Slot kFlagSlot = 1u << 31;
+    /**
+     * The command @name, or the command it is a unique prefix of if
+     * allowed, with its index in sub_parsers_. Otherwise the slot is
+     * RadixTree::kNotFound, or kAmbiguous.
+     */
+    flag::RadixTree::Match find_command(std::string_view name) const
+    {
+        if (allow_prefix_)
+        {
+            return names_.complete(name);
+        }
+        return flag::RadixTree::Match{name, names_.find(name)};
+    }
+    /**
+     * Insert into names_ the long flags registered, or used through a flag
+     * set, since the last call. The flags join the tree only once a lookup
+     * needs them, so that registering a flag costs nothing more.
+     */
+    void sync_flag_names() const
+    {
+        auto sync = [this](const flag::FlagStore &store, size_t &nr_named) {
+            for (; nr_named < store.size(); ++nr_named)
+            {
+                names_.insert(store.names_of(nr_named).first, kFlagSlot);
+            }
+        };
+        sync(*flag_store_, nr_named_flags_);
+        nr_named_set_flags_.resize(flag_sets_.size(), 0);
+        for (size_t i = 0; i < flag_sets_.size(); ++i)
+        {
+            sync(*flag_sets_[i]->store_, nr_named_set_flags_[i]);
+        }
+    }
+    void report_ambiguous(std::string_view name) const
+    {
+        std::cerr << "Failed to parse \"" << name << "\": ambiguous among [";
+        names_.for_each(name, [](std::string_view key, uint32_t) {
+            std::cerr << key << ", ";
+        });
+        std::cerr << "]." << std::endl;
+    }
+    void report_nearest(std::string_view name) const
+    {
+        sync_flag_names();
+        auto match = names_.nearest(name);
+        if (match.slot != flag::RadixTree::kNotFound)
+        {
+            std::cerr << " Did you mean \"" << match.key << "\"?";
+        }
+    }
+    bool do_parse(const Tokens &tokens,
+                  size_t cursor,
+                  ParserStore &store,
+                  std::pmr::vector<std::pmr::string> &command_path)
     {
         init_ = true;
-        store->link_flag_store(flag_store_);
+        flag_store_->reset();
+        store.link_flag_store(flag_store_, &flag_sets_);
 
-        for (auto pair_it = pairs.begin(); pair_it != pairs.end(); ++pair_it)
+        for (; cursor < tokens.size(); ++cursor)
         {
-            const auto &key = pair_it->first;
-            const auto &value = pair_it->second;
+            const auto &[key, value] = tokens[cursor];
 
             /**
              * It is either a flag or a command.
@@ -357,124 +1033,100 @@ private:
              */
             if (!flag::is_flag(key))
             {
-                auto parser_it = sub_parsers_.find(key);
-                if (parser_it == sub_parsers_.end())
-                {
-                    std::cerr << "Failed to parse command \"" << key
-                              << "\": use --help for usage." << std::endl;
-                    return false;
-                }
-                auto sub_parser = parser_it->second.get();
-                command_path.push_back(key);
-                // remove [begin, pair_it] and pass the remaining to the
-                // sub_parser
-                pairs.erase(pairs.begin(), ++pair_it);
-                return sub_parser->do_parse(pairs, store, command_path);
+                return parse_command(key, tokens, cursor, store, command_path);
             }
 
-            if (!flag_store_->apply(key, value) &&
-                !gf_store_->apply(key, value))
+            bool value_used = true;
+            if (!apply_flag(key, value, value_used))
             {
                 std::cerr << "Failed to apply " << key << "=\"" << value
                           << "\": Failure due to previous problem" << std::endl;
                 return false;
             }
+            /**
+             * The bundle took its value from within, e.g. -T8, so the next
+             * argv is a command: ./program -T8 start
+             */
+            if (!value_used && !value.empty())
+            {
+                if (is_attached(key, value))
+                {
+                    std::cerr << "Failed to apply " << key << "=\"" << value
+                              << "\": the bundle takes no value" << std::endl;
+                    return false;
+                }
+                return parse_command(
+                    value, tokens, cursor, store, command_path);
+            }
         }
 
-        auto missing_keys = flag_store_->missing_keys();
-        if (!missing_keys.empty())
+        if (!check_required(*flag_store_))
+        {
+            return false;
+        }
+        for (const auto &set : flag_sets_)
         {
-            std::cerr << "Failed to parse command line: [";
-            for (const auto &[full_name, short_name] : missing_keys)
+            if (!check_required(*set->store_))
             {
-                std::cerr << "{Flag " << full_name << ", " << short_name
-                          << "}, ";
+                return false;
             }
-            std::cerr << "] are required but not provided." << std::endl;
-            return false;
         }
-        return true;
+        return flag_store_->check_groups();
     }
-    static FlagPairs retrieve(int argc, const char *argv[])
+    static bool check_required(const flag::FlagStore &flag_store)
     {
-        FlagPairs ret;
-        // skip program name, i start from 1
-        for (int i = 1; i < argc; ++i)
+        if (flag_store.complete())
         {
-            std::string command_opt(argv[i]);
-            /**
-             * It is a command.
-             * e.g. ./program test
-             */
-            if (!flag::is_flag(command_opt))
-            {
-                ret.emplace_back(std::move(command_opt), "");
-                continue;
-            }
-
-            /**
-             * separate:
-             * --time 5
-             * not separate:
-             * --time=5
-             */
-            std::string key;
-            std::string value;
-            auto equal_pos = command_opt.find('=');
-            bool separate = equal_pos == std::string::npos;
-            if (!separate)
-            {
-                key = command_opt.substr(0, equal_pos);
-                value = command_opt.substr(equal_pos + 1);
-            }
-            else
-            {
-                /**
-                 * value may be the next argv
-                 * e.g. --time 5
-                 *
-                 * or it's a flag with no value
-                 * e.g. --flag_on
-                 */
-                key = command_opt;
-                if (i + 1 >= argc || flag::is_flag(argv[i + 1]))
-                {
-                    // no value.
-                }
-                else
-                {
-                    // value is the next argv
-                    value = argv[i + 1];
-                    // skip the next argv
-                    i++;
-                }
-            }
-            ret.emplace_back(key, value);
+            return true;
         }
-        return ret;
+        std::cerr << "Failed to parse command line: [";
+        for (const auto &[full_name, short_name] : flag_store.missing_keys())
+        {
+            std::cerr << "{Flag " << full_name << ", " << short_name << "}, ";
+        }
+        std::cerr << "] are required but not provided." << std::endl;
+        return false;
     }
 };  // namespace argparser
-std::shared_ptr<Parser> new_parser(const char *desc = "")
+/**
+ * Create a root parser. Pass a memory resource, e.g. a
+ * std::pmr::monotonic_buffer_resource, to serve the whole registration and
+ * parsing from it. The resource must outlive the parser.
+ */
+inline std::shared_ptr<Parser> new_parser(
+    const char *desc = "",
+    std::pmr::memory_resource *mr = std::pmr::get_default_resource())
 {
-    auto global_flag_store = std::make_shared<flag::FlagStore>();
-    return std::make_shared<Parser>(global_flag_store, desc);
+    auto global_flag_store = flag::FlagStore::new_instance(mr);
+    return std::allocate_shared<Parser>(
+        std::pmr::polymorphic_allocator<Parser>(mr),
+        global_flag_store,
+        desc,
+        mr);
 }
 
-Parser &init(const char *desc)
+inline Parser &init(const char *desc)
 {
     static std::shared_ptr<Parser> root_parser;
     if (root_parser == nullptr)
     {
         root_parser = new_parser(desc);
+        root_parser->load_registered_flags();
     }
     return *root_parser;
 }
 namespace impl
 {
-std::shared_ptr<Parser> new_parser(
-    std::shared_ptr<flag::FlagStore> global_flag_store, const char *desc = "")
+inline std::shared_ptr<Parser> new_parser(
+    std::shared_ptr<flag::FlagStore> global_flag_store,
+    const char *desc = "",
+    std::pmr::memory_resource *mr = std::pmr::get_default_resource())
 {
-    return std::make_shared<Parser>(global_flag_store, desc);
+    return std::allocate_shared<Parser>(
+        std::pmr::polymorphic_allocator<Parser>(mr),
+        global_flag_store,
+        desc,
+        mr);
 }
 
 }  // namespace impl
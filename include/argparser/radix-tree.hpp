@@ -0,0 +1,357 @@
+#ifndef ARG_PARSER_RADIX_TREE_H
+#define ARG_PARSER_RADIX_TREE_H
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace argparser
+{
+namespace flag
+{
+/**
+ * A compressed radix tree from names to slots, for the commands and the
+ * long flags of one parser level.
+ *
+ * A lookup walks one edge per branching point and compares the key in
+ * place, so it costs O(key length) and builds no string. Besides the exact
+ * lookup, the tree resolves a unique prefix to its key, lists the keys
+ * under a prefix in order, and finds the key sharing the longest prefix
+ * with a mistyped one.
+ *
+ * The keys are interned into one buffer owned by the tree, and the labels
+ * of the edges are views into it. The label of a node ends within a key
+ * passing through the node, so the key of a node is read right before the
+ * end of its label. The nodes live in one flat array and the children of
+ * a node are kept sorted by their first character.
+ */
+class RadixTree
+{
+public:
+    using Slot = uint32_t;
+    constexpr static Slot kNotFound = std::numeric_limits<Slot>::max();
+    // returned by complete() for a prefix of several keys
+    constexpr static Slot kAmbiguous = kNotFound - 1;
+
+    struct Match
+    {
+        std::string_view key;
+        Slot slot{kNotFound};
+    };
+
+    explicit RadixTree(
+        std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+        : nodes_(mr), keys_(mr)
+    {
+    }
+    ~RadixTree() = default;
+
+    /**
+     * Insert @key pointing to @slot.
+     * An empty key is never inserted. If @key is already in the tree, the
+     * previous slot is kept and false is returned.
+     */
+    bool insert(std::string_view key, Slot slot)
+    {
+        if (key.empty())
+        {
+            return false;
+        }
+        if (nodes_.empty())
+        {
+            // the root, with an empty label
+            nodes_.emplace_back();
+        }
+        Index node = kRoot;
+        size_t i = 0;
+        while (i < key.size())
+        {
+            Index prev = kNone;
+            Index child = nodes_[node].first_child;
+            while (child != kNone && label_of(child)[0] < key[i])
+            {
+                prev = child;
+                child = nodes_[child].next_sibling;
+            }
+            if (child == kNone || label_of(child)[0] != key[i])
+            {
+                Index leaf = nodes_.size();
+                auto offset = intern(key);
+                nodes_.emplace_back();
+                auto &added = nodes_[leaf];
+                added.label = Name{uint32_t(offset + i),
+                                   uint32_t(key.size() - i)};
+                added.depth = key.size();
+                added.slot = slot;
+                added.next_sibling = child;
+                link(node, prev, leaf);
+                return true;
+            }
+            auto label = label_of(child);
+            size_t common = common_prefix(label, key.substr(i));
+            if (common < label.size())
+            {
+                split(child, common);
+            }
+            node = child;
+            i += common;
+        }
+        auto &found = nodes_[node];
+        if (found.slot != kNotFound)
+        {
+            return false;
+        }
+        found.slot = slot;
+        return true;
+    }
+    Slot find(std::string_view key) const
+    {
+        if (key.empty() || nodes_.empty())
+        {
+            return kNotFound;
+        }
+        auto walk = descend(key);
+        if (walk.matched < key.size() || walk.partial != kNone)
+        {
+            return kNotFound;
+        }
+        return nodes_[walk.node].slot;
+    }
+    /**
+     * @prefix itself if it is a key, otherwise the only key starting with
+     * @prefix. The slot is kAmbiguous if several keys start with it, and
+     * kNotFound if none does.
+     */
+    Match complete(std::string_view prefix) const
+    {
+        auto node = subtree_of(prefix);
+        if (node == kNone)
+        {
+            return Match{};
+        }
+        if (nodes_[node].slot != kNotFound &&
+            nodes_[node].depth == prefix.size())
+        {
+            return match_of(node);
+        }
+        while (nodes_[node].slot == kNotFound)
+        {
+            auto child = nodes_[node].first_child;
+            if (child == kNone || nodes_[child].next_sibling != kNone)
+            {
+                return Match{std::string_view(), kAmbiguous};
+            }
+            node = child;
+        }
+        if (nodes_[node].first_child != kNone)
+        {
+            return Match{std::string_view(), kAmbiguous};
+        }
+        return match_of(node);
+    }
+    /**
+     * Call @f(key, slot) with every key starting with @prefix, in order.
+     */
+    template <typename F>
+    void for_each(std::string_view prefix, F &&f) const
+    {
+        auto node = subtree_of(prefix);
+        if (node != kNone)
+        {
+            visit(node, f);
+        }
+    }
+    /**
+     * The first key sharing the longest prefix with @key, if that prefix
+     * goes past the leading dashes and covers at least half of @key.
+     * Otherwise the slot is kNotFound.
+     */
+    Match nearest(std::string_view key) const
+    {
+        if (key.empty() || nodes_.empty())
+        {
+            return Match{};
+        }
+        auto walk = descend(key);
+        size_t dashes = key.find_first_not_of('-');
+        if (walk.matched <= dashes || 2 * walk.matched < key.size())
+        {
+            return Match{};
+        }
+        auto node = walk.partial != kNone ? walk.partial : walk.node;
+        while (nodes_[node].slot == kNotFound)
+        {
+            node = nodes_[node].first_child;
+        }
+        return match_of(node);
+    }
+    bool empty() const
+    {
+        // the root is added by the first key
+        return nodes_.empty();
+    }
+
+private:
+    using Index = uint32_t;
+    constexpr static Index kNone = std::numeric_limits<Index>::max();
+    constexpr static Index kRoot = 0;
+    struct Name
+    {
+        uint32_t offset{0};
+        uint32_t length{0};
+    };
+    struct Node
+    {
+        // the label of the edge from the parent
+        Name label;
+        // the length of the path from the root
+        uint32_t depth{0};
+        Slot slot{kNotFound};
+        Index first_child{kNone};
+        Index next_sibling{kNone};
+    };
+
+    std::string_view view_of(Name name) const
+    {
+        return std::string_view(keys_.data() + name.offset, name.length);
+    }
+    std::string_view label_of(Index node) const
+    {
+        return view_of(nodes_[node].label);
+    }
+    std::string_view key_of(Index node) const
+    {
+        const auto &label = nodes_[node].label;
+        auto end = label.offset + label.length;
+        return std::string_view(keys_.data() + end - nodes_[node].depth,
+                                nodes_[node].depth);
+    }
+    Match match_of(Index node) const
+    {
+        return Match{key_of(node), nodes_[node].slot};
+    }
+    static size_t common_prefix(std::string_view lhs, std::string_view rhs)
+    {
+        size_t i = 0;
+        while (i < lhs.size() && i < rhs.size() && lhs[i] == rhs[i])
+        {
+            i++;
+        }
+        return i;
+    }
+    uint32_t intern(std::string_view key)
+    {
+        auto offset = static_cast<uint32_t>(keys_.size());
+        keys_.append(key.data(), key.size());
+        return offset;
+    }
+    void link(Index parent, Index prev, Index child)
+    {
+        if (prev == kNone)
+        {
+            nodes_[parent].first_child = child;
+        }
+        else
+        {
+            nodes_[prev].next_sibling = child;
+        }
+    }
+    /**
+     * Cut the edge to @node after @at characters. @node keeps its place
+     * among its siblings and takes the upper part of the label; a new
+     * child takes the lower part, the slot and the children.
+     */
+    void split(Index node, size_t at)
+    {
+        Index lower = nodes_.size();
+        nodes_.emplace_back();
+        auto &upper = nodes_[node];
+        auto &added = nodes_[lower];
+        added.label = Name{uint32_t(upper.label.offset + at),
+                           uint32_t(upper.label.length - at)};
+        added.depth = upper.depth;
+        added.slot = upper.slot;
+        added.first_child = upper.first_child;
+        upper.depth -= added.label.length;
+        upper.label.length = at;
+        upper.slot = kNotFound;
+        upper.first_child = lower;
+    }
+    struct Walk
+    {
+        // the last node reached
+        Index node{kRoot};
+        // the child whose edge the walk stopped inside, or kNone
+        Index partial{kNone};
+        // the number of characters matched
+        size_t matched{0};
+    };
+    /**
+     * Walk down along @key as far as it matches.
+     */
+    Walk descend(std::string_view key) const
+    {
+        Index node = kRoot;
+        size_t i = 0;
+        while (i < key.size())
+        {
+            Index child = nodes_[node].first_child;
+            while (child != kNone && label_of(child)[0] != key[i])
+            {
+                child = nodes_[child].next_sibling;
+            }
+            if (child == kNone)
+            {
+                break;
+            }
+            auto label = label_of(child);
+            size_t common = common_prefix(label, key.substr(i));
+            i += common;
+            if (common < label.size())
+            {
+                return Walk{node, child, i};
+            }
+            node = child;
+        }
+        return Walk{node, kNone, i};
+    }
+    /**
+     * The node under which all the keys start with @prefix, or kNone.
+     */
+    Index subtree_of(std::string_view prefix) const
+    {
+        if (nodes_.empty())
+        {
+            return kNone;
+        }
+        auto walk = descend(prefix);
+        if (walk.matched < prefix.size())
+        {
+            return kNone;
+        }
+        return walk.partial != kNone ? walk.partial : walk.node;
+    }
+    template <typename F>
+    void visit(Index node, F &f) const
+    {
+        if (nodes_[node].slot != kNotFound)
+        {
+            f(key_of(node), nodes_[node].slot);
+        }
+        for (auto child = nodes_[node].first_child; child != kNone;
+             child = nodes_[child].next_sibling)
+        {
+            visit(child, f);
+        }
+    }
+
+    std::pmr::vector<Node> nodes_;
+    std::pmr::string keys_;
+};
+
+}  // namespace flag
+}  // namespace argparser
+#endif
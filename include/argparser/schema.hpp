@@ -0,0 +1,388 @@
+#ifndef ARG_PARSER_SCHEMA_H
+#define ARG_PARSER_SCHEMA_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string_view>
+
+#include "./common.hpp"
+#include "./flag-registry.hpp"
+#include "./tokenizer.hpp"
+
+/**
+ * A flat table of flags declared at compile time:
+ *
+ *   constexpr auto kSchema = argparser::schema::make(
+ *       argparser::schema::flag<int>("--threads", "-t", "threads", "4"),
+ *       argparser::schema::required<std::string>("--file", "-f", "file"));
+ *   int threads;
+ *   std::string file;
+ *   kSchema.parse(argc, argv, &threads, &file);
+ *
+ * A badly formed or duplicated name fails the constant evaluation, so it is
+ * a compile error. A perfect hash over all the names is built at compile
+ * time: looking a flag up is two hashes, one compare and a direct write into
+ * the bound variable. A schema has no commands.
+ */
+namespace argparser
+{
+namespace schema
+{
+/**
+ * Reached in a constant evaluation, these fail the compilation and their
+ * name is the error message.
+ */
+namespace error
+{
+inline void flag_name_not_allowed()
+{
+    std::cerr << "Failed to build schema: identity not allowed" << std::endl;
+    std::terminate();
+}
+inline void flag_already_registered()
+{
+    std::cerr << "Failed to build schema: flag already registered"
+              << std::endl;
+    std::terminate();
+}
+inline void no_perfect_hash_found()
+{
+    std::cerr << "Failed to build schema: no perfect hash found" << std::endl;
+    std::terminate();
+}
+}  // namespace error
+
+template <typename T>
+struct Flag
+{
+    std::string_view full_name;
+    std::string_view short_name;
+    std::string_view desc;
+    // nullptr if the flag is required
+    const char *default_val;
+};
+template <typename T>
+constexpr Flag<T> flag(std::string_view full_name,
+                       std::string_view short_name,
+                       std::string_view desc,
+                       const char *default_val)
+{
+    return Flag<T>{full_name, short_name, desc, default_val};
+}
+template <typename T>
+constexpr Flag<T> required(std::string_view full_name,
+                           std::string_view short_name,
+                           std::string_view desc)
+{
+    return Flag<T>{full_name, short_name, desc, nullptr};
+}
+
+/**
+ * One flag of a Schema, with the type erased.
+ */
+struct Spec
+{
+    std::string_view full_name;
+    std::string_view short_name;
+    std::string_view desc;
+    const char *default_val;
+    bool (*apply)(void *slot, std::string_view value);
+};
+
+/**
+ * FNV-1a, with @seed mixed into the basis.
+ */
+constexpr uint64_t hash(std::string_view name, uint64_t seed)
+{
+    uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+    for (char c : name)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+constexpr size_t next_pow2(size_t n)
+{
+    size_t ret = 1;
+    while (ret < n)
+    {
+        ret *= 2;
+    }
+    return ret;
+}
+
+template <typename... Ts>
+class Schema
+{
+public:
+    constexpr static size_t kFlagNr = sizeof...(Ts);
+    // every flag has at most two names
+    constexpr static size_t kMaxKeyNr = 2 * kFlagNr;
+
+    constexpr explicit Schema(const Flag<Ts> &...flags)
+        : specs_{Spec{flags.full_name,
+                      flags.short_name,
+                      flags.desc,
+                      flags.default_val,
+                      &registry::apply_slot<Ts>}...}
+    {
+        for (size_t i = 0; i < kFlagNr; ++i)
+        {
+            if (!registry::valid_names(specs_[i].full_name,
+                                       specs_[i].short_name))
+            {
+                error::flag_name_not_allowed();
+            }
+            add_key(specs_[i].full_name, i);
+            add_key(specs_[i].short_name, i);
+        }
+        build_hash();
+    }
+
+    /**
+     * The id of the flag named @name, or kFlagNr.
+     */
+    constexpr size_t find(std::string_view name) const
+    {
+        if (key_nr_ == 0)
+        {
+            return kFlagNr;
+        }
+        size_t bucket = hash(name, 0) % kBucketNr;
+        size_t key = table_[hash(name, seeds_[bucket]) % kSlotNr];
+        if (key == kEmpty || keys_[key] != name)
+        {
+            return kFlagNr;
+        }
+        return flag_of_[key];
+    }
+    constexpr const Spec &spec(size_t id) const
+    {
+        return specs_[id];
+    }
+
+    /**
+     * Parse argv into @slots, one per flag, in the order of the schema.
+     * The flags not given take their default values, which are converted
+     * only for them.
+     */
+    bool parse(int argc, const char *argv[], Ts *...slots) const
+    {
+        std::array<void *, kFlagNr> bound{static_cast<void *>(slots)...};
+        std::array<bool, kFlagNr> applied{};
+        bool succ = true;
+        for_each_token(argc, argv, [&](const Token &token) {
+            if (succ)
+            {
+                succ = apply(bound, applied, token.key, token.value);
+            }
+        });
+        if (!succ || !check_required(applied))
+        {
+            return false;
+        }
+        for (size_t id = 0; id < kFlagNr; ++id)
+        {
+            const auto &spec = specs_[id];
+            if (!applied[id] && spec.default_val != nullptr &&
+                !spec.apply(bound[id], spec.default_val))
+            {
+                std::cerr << "Failed to register flag " << spec.full_name
+                          << ": default value \"" << spec.default_val
+                          << "\" not parsable" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    constexpr static size_t kEmpty = kMaxKeyNr;
+    constexpr static size_t kBucketNr = kMaxKeyNr == 0 ? 1 : kMaxKeyNr;
+    constexpr static size_t kSlotNr = next_pow2(2 * kMaxKeyNr);
+    // the seeds tried per bucket before giving up
+    constexpr static uint64_t kMaxSeed = 1u << 16;
+
+    constexpr void add_key(std::string_view name, size_t id)
+    {
+        if (name.empty())
+        {
+            return;
+        }
+        for (size_t key = 0; key < key_nr_; ++key)
+        {
+            if (keys_[key] == name)
+            {
+                error::flag_already_registered();
+            }
+        }
+        keys_[key_nr_] = name;
+        flag_of_[key_nr_] = id;
+        key_nr_++;
+    }
+
+    /**
+     * Hash and displace: the keys are spread into buckets by one hash, then
+     * for every bucket, the largest first, a seed is searched so that a
+     * second hash puts all its keys into free slots.
+     */
+    constexpr void build_hash()
+    {
+        for (auto &key : table_)
+        {
+            key = kEmpty;
+        }
+        std::array<size_t, kBucketNr> bucket_of{};
+        std::array<size_t, kBucketNr> bucket_size{};
+        std::array<size_t, kMaxKeyNr + 1> bucket_keys{};
+        for (size_t key = 0; key < key_nr_; ++key)
+        {
+            bucket_of[key] = hash(keys_[key], 0) % kBucketNr;
+            bucket_size[bucket_of[key]]++;
+        }
+        std::array<size_t, kBucketNr> order{};
+        for (size_t b = 0; b < kBucketNr; ++b)
+        {
+            order[b] = b;
+        }
+        // selection sort, by bucket size descending
+        for (size_t i = 0; i < kBucketNr; ++i)
+        {
+            size_t max = i;
+            for (size_t j = i + 1; j < kBucketNr; ++j)
+            {
+                if (bucket_size[order[j]] > bucket_size[order[max]])
+                {
+                    max = j;
+                }
+            }
+            size_t tmp = order[i];
+            order[i] = order[max];
+            order[max] = tmp;
+        }
+        for (size_t i = 0; i < kBucketNr && bucket_size[order[i]] != 0; ++i)
+        {
+            size_t bucket = order[i];
+            size_t nr = 0;
+            for (size_t key = 0; key < key_nr_; ++key)
+            {
+                if (bucket_of[key] == bucket)
+                {
+                    bucket_keys[nr++] = key;
+                }
+            }
+            if (!place(bucket, bucket_keys, nr))
+            {
+                error::no_perfect_hash_found();
+            }
+        }
+    }
+    constexpr bool place(size_t bucket,
+                         const std::array<size_t, kMaxKeyNr + 1> &keys,
+                         size_t nr)
+    {
+        for (uint64_t seed = 1; seed < kMaxSeed; ++seed)
+        {
+            std::array<size_t, kMaxKeyNr + 1> slots{};
+            bool ok = true;
+            for (size_t i = 0; i < nr && ok; ++i)
+            {
+                slots[i] = hash(keys_[keys[i]], seed) % kSlotNr;
+                ok = table_[slots[i]] == kEmpty;
+                for (size_t j = 0; j < i && ok; ++j)
+                {
+                    ok = slots[j] != slots[i];
+                }
+            }
+            if (!ok)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < nr; ++i)
+            {
+                table_[slots[i]] = keys[i];
+            }
+            seeds_[bucket] = seed;
+            return true;
+        }
+        return false;
+    }
+
+    bool apply(const std::array<void *, kFlagNr> &bound,
+               std::array<bool, kFlagNr> &applied,
+               std::string_view key,
+               std::string_view value) const
+    {
+        size_t id = find(key);
+        if (id == kFlagNr)
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value
+                      << "\": flag not found" << std::endl;
+            return false;
+        }
+        if (applied[id])
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value << "\": "
+                      << "Flag " << key
+                      << " already set and is provided more than once."
+                      << std::endl;
+            return false;
+        }
+        if (!specs_[id].apply(bound[id], value))
+        {
+            std::cerr << "Failed to apply " << key << "=\"" << value
+                      << "\": \"" << value << "\" not parsable" << std::endl;
+            return false;
+        }
+        applied[id] = true;
+        return true;
+    }
+    bool check_required(const std::array<bool, kFlagNr> &applied) const
+    {
+        bool missing = false;
+        for (size_t id = 0; id < kFlagNr; ++id)
+        {
+            const auto &spec = specs_[id];
+            if (spec.default_val != nullptr || applied[id])
+            {
+                continue;
+            }
+            if (!missing)
+            {
+                std::cerr << "Failed to parse command line: [";
+                missing = true;
+            }
+            std::cerr << "{Flag " << spec.full_name << ", " << spec.short_name
+                      << "}, ";
+        }
+        if (missing)
+        {
+            std::cerr << "] are required but not provided." << std::endl;
+        }
+        return !missing;
+    }
+
+    std::array<Spec, kFlagNr> specs_;
+    std::array<std::string_view, kMaxKeyNr> keys_{};
+    // the flag of every key
+    std::array<size_t, kMaxKeyNr> flag_of_{};
+    size_t key_nr_{0};
+    std::array<uint64_t, kBucketNr> seeds_{};
+    // the key in every slot, or kEmpty
+    std::array<size_t, kSlotNr> table_{};
+};
+
+template <typename... Ts>
+constexpr Schema<Ts...> make(const Flag<Ts> &...flags)
+{
+    return Schema<Ts...>(flags...);
+}
+
+}  // namespace schema
+}  // namespace argparser
+#endif
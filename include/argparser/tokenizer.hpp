@@ -0,0 +1,146 @@
+#ifndef ARG_PARSER_TOKENIZER_H
+#define ARG_PARSER_TOKENIZER_H
+
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "./common.hpp"
+
+namespace argparser
+{
+/**
+ * One command-line token: either a command or a flag with its value.
+ * Both @key and @value point straight into argv, so the tokens must not
+ * outlive it. A command, or a flag without a value, has an empty @value.
+ */
+struct Token
+{
+    std::string_view key;
+    std::string_view value;
+};
+using Tokens = std::pmr::vector<Token>;
+
+/**
+ * Call @f with every token of argv in order, skipping the program name.
+ * Nothing is allocated.
+ */
+template <typename F>
+void for_each_token(int argc, const char *argv[], F &&f)
+{
+    // skip program name, i start from 1
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view command_opt(argv[i]);
+        /**
+         * It is a command.
+         * e.g. ./program test
+         */
+        if (!flag::is_flag(command_opt))
+        {
+            f(Token{command_opt, {}});
+            continue;
+        }
+
+        /**
+         * separate:
+         * --time 5
+         * not separate:
+         * --time=5
+         */
+        auto equal_pos = command_opt.find('=');
+        if (equal_pos != std::string_view::npos)
+        {
+            f(Token{command_opt.substr(0, equal_pos),
+                    command_opt.substr(equal_pos + 1)});
+            continue;
+        }
+        /**
+         * value may be the next argv
+         * e.g. --time 5
+         *
+         * or it's a flag with no value
+         * e.g. --flag_on
+         */
+        if (i + 1 >= argc || flag::is_flag(argv[i + 1]))
+        {
+            f(Token{command_opt, {}});
+        }
+        else
+        {
+            // value is the next argv, skip it
+            f(Token{command_opt, argv[i + 1]});
+            i++;
+        }
+    }
+}
+
+/**
+ * Whether the value of a token of for_each_token() was given in the same
+ * argv as its key, e.g. --time=5.
+ */
+inline bool is_attached(std::string_view key, std::string_view value)
+{
+    return value.data() == key.data() + key.size() + 1;
+}
+
+/**
+ * Apply the bundle of short flags @key with the token @value, the way of
+ * POSIX getopt: every letter is a flag, and the first one that is not a
+ * switch takes the rest of the bundle as its value. The last flag takes
+ * @value, so -vxf, -T8 and -vT 8 all work.
+ *
+ * @is_switch(name) tells whether the flag takes no value in a bundle,
+ * @apply(name, value) applies one flag. @value_used is set to whether
+ * @value went to a flag.
+ */
+template <typename IsSwitch, typename Apply>
+bool apply_short_bundle(std::string_view key,
+                        std::string_view value,
+                        bool &value_used,
+                        IsSwitch &&is_switch,
+                        Apply &&apply)
+{
+    value_used = false;
+    for (size_t i = 1; i < key.size(); ++i)
+    {
+        auto name = flag::short_name_of(key[i]);
+        auto rest = key.substr(i + 1);
+        if (rest.empty())
+        {
+            value_used = true;
+            return apply(name, value);
+        }
+        if (!is_switch(name))
+        {
+            return apply(name, rest);
+        }
+        if (!apply(name, std::string_view()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Split argv into a flat array of tokens, skipping the program name.
+ * The array is allocated once from @mr; no token allocates on its own.
+ */
+inline Tokens tokenize(
+    int argc,
+    const char *argv[],
+    std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+{
+    Tokens ret(mr);
+    if (argc > 1)
+    {
+        ret.reserve(argc - 1);
+    }
+    for_each_token(
+        argc, argv, [&ret](const Token &token) { ret.push_back(token); });
+    return ret;
+}
+
+}  // namespace argparser
+#endif
@@ -0,0 +1,109 @@
+#ifndef ARG_PARSER_TYPED_CACHE_H
+#define ARG_PARSER_TYPED_CACHE_H
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace argparser
+{
+namespace flag
+{
+/**
+ * A small cache of typed values keyed by type, at most one value per type.
+ *
+ * Lookups walk a short lock-free list, so concurrent readers are safe and a
+ * cached read costs a few pointer loads. A failed conversion is cached as
+ * std::nullopt as well. A copy of the cache starts empty.
+ */
+class TypedCache
+{
+public:
+    TypedCache() = default;
+    TypedCache(const TypedCache &) noexcept
+    {
+    }
+    TypedCache &operator=(const TypedCache &)
+    {
+        clear();
+        return *this;
+    }
+    ~TypedCache()
+    {
+        clear();
+    }
+
+    /**
+     * Return the value cached for type T. Call @convert to produce the value
+     * if it is not cached yet.
+     */
+    template <typename T, typename Convert>
+    const std::optional<T> &get(Convert &&convert) const
+    {
+        const void *key = key_of<T>();
+        for (auto *node = head_.load(std::memory_order_acquire);
+             node != nullptr;
+             node = node->next)
+        {
+            if (node->key == key)
+            {
+                return static_cast<const TypedNode<T> *>(node)->value;
+            }
+        }
+        // two racing readers may both insert, which is harmless.
+        auto *node = new TypedNode<T>(key, convert());
+        node->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next,
+                                            node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed))
+        {
+        }
+        return node->value;
+    }
+    /**
+     * Drop all the cached values. Not safe against concurrent get().
+     */
+    void clear()
+    {
+        auto *node = head_.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            auto *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    struct Node
+    {
+        Node(const void *k) : key(k)
+        {
+        }
+        virtual ~Node() = default;
+        const void *key;
+        Node *next{nullptr};
+    };
+    template <typename T>
+    struct TypedNode : public Node
+    {
+        TypedNode(const void *k, std::optional<T> &&v)
+            : Node(k), value(std::move(v))
+        {
+        }
+        std::optional<T> value;
+    };
+    template <typename T>
+    static const void *key_of()
+    {
+        static const char key = 0;
+        return &key;
+    }
+
+    mutable std::atomic<Node *> head_{nullptr};
+};
+
+}  // namespace flag
+}  // namespace argparser
+#endif
@@ -0,0 +1,277 @@
+#ifndef ARG_PARSER_TYPED_SLOT_H
+#define ARG_PARSER_TYPED_SLOT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "./convert.hpp"
+#include "./flag.hpp"
+
+namespace argparser
+{
+namespace flag
+{
+/**
+ * The target of a typed flag, held by value.
+ *
+ * The common types are alternatives of a closed variant and every other
+ * type is erased into a pointer plus a static table of its conversions, so
+ * binding a variable allocates nothing. A flag bound to a member of a class
+ * needs state of its own and stays a Flag. Every operation is one switch
+ * over the alternative, no virtual call is involved but for members.
+ */
+class TypedSlot
+{
+public:
+    struct ErasedOps
+    {
+        bool (*apply)(void *slot, std::string_view value);
+        bool (*parsable)(std::string_view value);
+        std::string_view (*choices)();
+        std::string_view (*suggest)(std::string_view value);
+    };
+    struct Erased
+    {
+        void *slot;
+        const ErasedOps *ops;
+    };
+    using Target = std::variant<std::monostate,
+                                bool *,
+                                int32_t *,
+                                int64_t *,
+                                uint32_t *,
+                                uint64_t *,
+                                double *,
+                                std::string *,
+                                Erased,
+                                Flag::Pointer>;
+
+    TypedSlot() = default;
+    template <typename T>
+    explicit TypedSlot(T *slot)
+    {
+        if constexpr (is_alternative<T *>())
+        {
+            target_ = slot;
+        }
+        else
+        {
+            target_ = Erased{static_cast<void *>(slot), &kErasedOps<T>};
+        }
+    }
+    /**
+     * A flag bound to a member, see MemberFlag.
+     */
+    explicit TypedSlot(Flag::Pointer member) : target_(std::move(member))
+    {
+    }
+
+    bool empty() const
+    {
+        return target_.index() == 0;
+    }
+    /**
+     * Whether the target is a bool, which a bundle of short flags gives
+     * without a value.
+     */
+    bool is_switch() const
+    {
+        return std::holds_alternative<bool *>(target_);
+    }
+    /**
+     * The flag if it is bound to a member, otherwise nullptr.
+     */
+    const Flag *member() const
+    {
+        auto *flag = std::get_if<Flag::Pointer>(&target_);
+        return flag == nullptr ? nullptr : flag->get();
+    }
+
+    /**
+     * Convert @value and write it to the target. A flag bound to a member
+     * only checks it.
+     */
+    bool apply(std::string_view value) const
+    {
+        return visit(Apply{value});
+    }
+    bool parsable(std::string_view value) const
+    {
+        return visit(Parsable{value});
+    }
+    std::string_view choices() const
+    {
+        return visit(Choices{});
+    }
+    std::string_view suggest(std::string_view value) const
+    {
+        return visit(Suggest{value});
+    }
+
+private:
+    template <typename P, size_t I = 0>
+    constexpr static bool is_alternative()
+    {
+        if constexpr (I == std::variant_size_v<Target>)
+        {
+            return false;
+        }
+        else
+        {
+            return std::is_same_v<P, std::variant_alternative_t<I, Target>> ||
+                   is_alternative<P, I + 1>();
+        }
+    }
+
+    template <typename T>
+    static bool erased_apply(void *slot, std::string_view value)
+    {
+        return write(static_cast<T *>(slot), value);
+    }
+    template <typename T>
+    static bool erased_parsable(std::string_view value)
+    {
+        return argparse::convert::try_to<T>(value).has_value();
+    }
+    template <typename T>
+    constexpr static ErasedOps kErasedOps{&erased_apply<T>,
+                                          &erased_parsable<T>,
+                                          &argparse::convert::choices_of<T>,
+                                          &argparse::convert::suggest_for<T>};
+
+    template <typename T>
+    static bool write(T *slot, std::string_view value)
+    {
+        auto maybe = argparse::convert::try_to<T>(value);
+        if (!maybe.has_value())
+        {
+            return false;
+        }
+        *slot = std::move(maybe.value());
+        return true;
+    }
+
+    struct Apply
+    {
+        std::string_view value;
+        bool operator()(std::monostate) const
+        {
+            return false;
+        }
+        template <typename T>
+        bool operator()(T *slot) const
+        {
+            return write(slot, value);
+        }
+        bool operator()(const Erased &erased) const
+        {
+            return erased.ops->apply(erased.slot, value);
+        }
+        bool operator()(const Flag::Pointer &member) const
+        {
+            return member->apply(value);
+        }
+    };
+    struct Parsable
+    {
+        std::string_view value;
+        bool operator()(std::monostate) const
+        {
+            return false;
+        }
+        template <typename T>
+        bool operator()(T *) const
+        {
+            return argparse::convert::try_to<T>(value).has_value();
+        }
+        bool operator()(const Erased &erased) const
+        {
+            return erased.ops->parsable(value);
+        }
+        bool operator()(const Flag::Pointer &member) const
+        {
+            return member->parsable(value);
+        }
+    };
+    struct Choices
+    {
+        std::string_view operator()(std::monostate) const
+        {
+            return {};
+        }
+        template <typename T>
+        std::string_view operator()(T *) const
+        {
+            return argparse::convert::choices_of<T>();
+        }
+        std::string_view operator()(const Erased &erased) const
+        {
+            return erased.ops->choices();
+        }
+        std::string_view operator()(const Flag::Pointer &member) const
+        {
+            return member->choices();
+        }
+    };
+    struct Suggest
+    {
+        std::string_view value;
+        std::string_view operator()(std::monostate) const
+        {
+            return {};
+        }
+        template <typename T>
+        std::string_view operator()(T *) const
+        {
+            return argparse::convert::suggest_for<T>(value);
+        }
+        std::string_view operator()(const Erased &erased) const
+        {
+            return erased.ops->suggest(value);
+        }
+        std::string_view operator()(const Flag::Pointer &member) const
+        {
+            return member->suggest(value);
+        }
+    };
+
+    template <typename F>
+    auto visit(F &&f) const -> decltype(f(std::monostate{}))
+    {
+        switch (target_.index())
+        {
+        case 1:
+            return f(*std::get_if<1>(&target_));
+        case 2:
+            return f(*std::get_if<2>(&target_));
+        case 3:
+            return f(*std::get_if<3>(&target_));
+        case 4:
+            return f(*std::get_if<4>(&target_));
+        case 5:
+            return f(*std::get_if<5>(&target_));
+        case 6:
+            return f(*std::get_if<6>(&target_));
+        case 7:
+            return f(*std::get_if<7>(&target_));
+        case 8:
+            return f(*std::get_if<8>(&target_));
+        case 9:
+            return f(*std::get_if<9>(&target_));
+        default:
+            return f(std::monostate{});
+        }
+    }
+    static_assert(std::variant_size_v<Target> == 10,
+                  "visit() must switch over every alternative");
+
+    Target target_;
+};
+
+}  // namespace flag
+}  // namespace argparser
+#endif
@@ -0,0 +1,241 @@
+#include <inttypes.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+#include "commands.hpp"
+#include "gtest/gtest.h"
+
+/**
+ * Allocation budgets of fixed scenarios. A scenario fails once it makes
+ * more allocations, or allocates more bytes, than its budget.
+ *
+ * The numbers are measured with libstdc++ on x86-64 plus some headroom.
+ * Lower them when an optimization lands; raising them needs a reason.
+ */
+namespace
+{
+struct Budget
+{
+    size_t nr;
+    size_t bytes;
+};
+// 1000 stored flags through Parser::flag
+constexpr Budget kRegisterFlags{80, 680 * 1024};
+// 1000 flags bound to variables through Parser::flag
+constexpr Budget kRegisterTypedFlags{80, 640 * 1024};
+// 1000 flags bound to variables through one Parser::flags
+constexpr Budget kRegisterBulkFlags{16, 256 * 1024};
+// register_arg() of examples/commands.cpp. Every level with commands owns
+// a radix tree of its names, about 1K more than the hash map it replaced.
+constexpr Budget kRegisterCommands{140, 34 * 1024};
+// one parse of the commands tree
+constexpr Budget kParseCommands{4, 320};
+// 1000 reads of AllocatedFlag::to<T>() of one flag
+constexpr Budget kFlagReads{2, 64};
+// 1000 lookups of long names through ParserStore, FlagStore and Parser
+constexpr Budget kLookups{0, 0};
+
+size_t nr_alloc = 0;
+size_t nr_bytes = 0;
+
+struct Usage
+{
+    size_t nr;
+    size_t bytes;
+};
+class AllocationScope
+{
+public:
+    AllocationScope() : nr_(nr_alloc), bytes_(nr_bytes)
+    {
+    }
+    Usage usage() const
+    {
+        return Usage{nr_alloc - nr_, nr_bytes - bytes_};
+    }
+
+private:
+    size_t nr_;
+    size_t bytes_;
+};
+void expect_within(const char *scenario, Usage usage, Budget budget)
+{
+    std::cout << scenario << ": " << usage.nr << " allocations, "
+              << usage.bytes << " bytes (budget " << budget.nr << ", "
+              << budget.bytes << ")" << std::endl;
+    ::testing::Test::RecordProperty(std::string(scenario) + ".allocations",
+                                    std::to_string(usage.nr));
+    ::testing::Test::RecordProperty(std::string(scenario) + ".bytes",
+                                    std::to_string(usage.bytes));
+    EXPECT_LE(usage.nr, budget.nr) << scenario;
+    EXPECT_LE(usage.bytes, budget.bytes) << scenario;
+}
+void *counted_alloc(std::size_t size, std::size_t alignment)
+{
+    nr_alloc++;
+    nr_bytes += size;
+    size = (size + alignment - 1) / alignment * alignment;
+    if (void *ptr = std::aligned_alloc(alignment, size == 0 ? alignment : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+}  // namespace
+
+void *operator new(std::size_t size)
+{
+    return counted_alloc(size, alignof(std::max_align_t));
+}
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    return counted_alloc(size, static_cast<size_t>(align));
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST(ArgparserAllocation, RegisterFlags)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    AllocationScope scope;
+    auto parser = argparser::new_parser();
+    bool succ = true;
+    for (const auto &name : names)
+    {
+        succ &= parser->flag(name.c_str(), "", "", "0");
+    }
+    auto usage = scope.usage();
+    EXPECT_TRUE(succ);
+    expect_within("register_flags", usage, kRegisterFlags);
+}
+
+TEST(ArgparserAllocation, RegisterTypedFlags)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    std::vector<int64_t> values(names.size());
+    AllocationScope scope;
+    auto parser = argparser::new_parser();
+    bool succ = true;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        succ &= parser->flag(&values[i], names[i].c_str(), "", "", "0");
+    }
+    auto usage = scope.usage();
+    EXPECT_TRUE(succ);
+    expect_within("register_typed_flags", usage, kRegisterTypedFlags);
+}
+
+TEST(ArgparserAllocation, RegisterBulkFlags)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    std::vector<int64_t> values(names.size());
+    std::vector<argparser::registry::FlagDescriptor> table;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        table.push_back(argparser::registry::describe(
+            &values[i], names[i].c_str(), "", "", "0"));
+    }
+    AllocationScope scope;
+    auto parser = argparser::new_parser();
+    bool succ = parser->flags(table.data(), table.size());
+    auto usage = scope.usage();
+    EXPECT_TRUE(succ);
+    expect_within("register_bulk_flags", usage, kRegisterBulkFlags);
+}
+
+TEST(ArgparserAllocation, RegisterCommands)
+{
+    AllocationScope scope;
+    auto parser = argparser::new_parser("lots of commands");
+    register_arg(*parser);
+    expect_within("register_commands", scope.usage(), kRegisterCommands);
+}
+
+TEST(ArgparserAllocation, ParseCommands)
+{
+    auto parser = argparser::new_parser("lots of commands");
+    register_arg(*parser);
+    const char *arg[] = {
+        "./commands", "file", "--size", "4M", "--file", "/dev/pmem0"};
+
+    AllocationScope scope;
+    bool succ = parser->parse(sizeof(arg) / sizeof(arg[0]), arg);
+    auto usage = scope.usage();
+    EXPECT_TRUE(succ);
+    expect_within("parse_commands", usage, kParseCommands);
+}
+
+TEST(ArgparserAllocation, FlagReads)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--batch", "-b", "", "128"));
+    const char *arg[] = {"./argtest", "-b", "256"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    const auto &flag = parser->store().get("--batch");
+
+    AllocationScope scope;
+    int64_t sum = 0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        sum += flag.to<int64_t>();
+    }
+    auto usage = scope.usage();
+    EXPECT_EQ(sum, 256 * 1000);
+    expect_within("flag_reads", usage, kFlagReads);
+}
+
+TEST(ArgparserAllocation, Lookups)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--a-rather-long-flag-name", "-a", "", "1"));
+    EXPECT_TRUE(
+        parser->global_flag("--a-rather-long-global-flag", "", "", "2"));
+    parser->command("a-rather-long-command-name", "");
+    const char *arg[] = {"./argtest"};
+    EXPECT_TRUE(parser->parse(1, arg));
+
+    AllocationScope scope;
+    size_t found = 0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        const auto &store = parser->store();
+        found += store.has("--a-rather-long-flag-name");
+        found += &store.get("--a-rather-long-global-flag") != nullptr;
+        found += !store.has("--a-rather-long-missing-flag");
+        found += &parser->command("a-rather-long-command-name") != nullptr;
+    }
+    auto usage = scope.usage();
+    EXPECT_EQ(found, 4 * 1000);
+    expect_within("lookups", usage, kLookups);
+}
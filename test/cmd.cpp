@@ -1,6 +1,7 @@
 #include <inttypes.h>
 
 #include <string>
+#include <vector>
 
 #include "argparser/argparser.hpp"
 #include "gtest/gtest.h"
@@ -403,6 +404,247 @@ TEST(ArgparserCommand, ExtraFlagsIsAnError2)
     const char *arg[] = {"./argtest", "same", "--i=246810", "--j=12345"};
     EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
 }
+TEST(ArgparserCommand, ShouldMatchUniquePrefix)
+{
+    int64_t threads = 0;
+    int64_t time = 0;
+    auto parser = argparser::new_parser();
+    auto &spin = parser->command("spin-lock");
+    parser->command("spawn");
+    parser->command("run");
+    EXPECT_TRUE(spin.flag(&threads, "--threads", "-t", "", "1"));
+    EXPECT_TRUE(spin.flag(&time, "--time", "", "", "0"));
+
+    const char *arg[] = {"./argtest", "spin", "--thr", "4"};
+    EXPECT_FALSE(parser->parse(4, arg));
+
+    parser->allow_prefix();
+    EXPECT_TRUE(parser->parse(4, arg));
+    EXPECT_EQ(threads, 4);
+    EXPECT_EQ(parser->command_path(), std::vector<std::string>{"spin-lock"});
+
+    // exact names win, and spin-lock gets the setting as well
+    const char *exact[] = {"./argtest", "run"};
+    EXPECT_TRUE(parser->parse(2, exact));
+    const char *ambiguous[] = {"./argtest", "sp"};
+    EXPECT_FALSE(parser->parse(2, ambiguous));
+    const char *flag[] = {"./argtest", "spin-lock", "--t", "4"};
+    EXPECT_FALSE(parser->parse(4, flag));
+    const char *both[] = {"./argtest", "spin", "--thr", "2", "--ti", "3"};
+    EXPECT_TRUE(parser->parse(6, both));
+    EXPECT_EQ(time, 3);
+}
+TEST(ArgparserCommand, ShouldCompleteAndSuggest)
+{
+    auto parser = argparser::new_parser();
+    parser->command("start");
+    parser->command("stop");
+    parser->command("status");
+    EXPECT_TRUE(parser->flag("--threads", "", "", "1"));
+    EXPECT_TRUE(parser->flag("--time", "", "", "0"));
+
+    EXPECT_EQ(parser->complete("st"),
+              std::vector<std::string>({"start", "status", "stop"}));
+    EXPECT_EQ(parser->complete("--t"),
+              std::vector<std::string>({"--threads", "--time"}));
+    EXPECT_TRUE(parser->complete("x").empty());
+
+    testing::internal::CaptureStderr();
+    const char *command[] = {"./argtest", "stat"};
+    EXPECT_FALSE(parser->parse(2, command));
+    auto err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("Did you mean \"status\"?"), std::string::npos);
+
+    testing::internal::CaptureStderr();
+    const char *flag[] = {"./argtest", "--thraeds", "4"};
+    EXPECT_FALSE(parser->parse(3, flag));
+    err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("Did you mean \"--threads\"?"), std::string::npos);
+}
+TEST(ArgparserCommand, ShouldShareFlagSets)
+{
+    int64_t threads = 0;
+    auto run_flags = argparser::new_flag_set("Run Flags");
+    EXPECT_TRUE(run_flags->flag(&threads, "--threads", "-T", "", "1"));
+    EXPECT_TRUE(run_flags->flag("--time", "-t", ""));
+    EXPECT_FALSE(run_flags->flag("--time", "", ""));
+
+    auto parser = argparser::new_parser();
+    auto &cas = parser->command("cas");
+    auto &lock = parser->command("lock");
+    EXPECT_TRUE(cas.use(run_flags));
+    EXPECT_TRUE(lock.use(run_flags));
+    EXPECT_TRUE(lock.flag("--fair", "", "", "false"));
+    EXPECT_FALSE(lock.flag("--time", "", "", "0"));
+    auto &add = parser->command("add");
+    EXPECT_TRUE(add.flag("--threads", "", "", "1"));
+    EXPECT_FALSE(add.use(run_flags));
+
+    const char *cas_arg[] = {"./argtest", "cas", "-T", "4", "--time", "3"};
+    EXPECT_TRUE(parser->parse(6, cas_arg));
+    EXPECT_EQ(threads, 4);
+    EXPECT_EQ(parser->store().get("--time").to<int>(), 3);
+
+    // the applied flags of the set follow the parse
+    const char *lock_arg[] = {"./argtest", "lock", "-t", "5", "--fair"};
+    EXPECT_TRUE(parser->parse(5, lock_arg));
+    EXPECT_EQ(threads, 1);
+    EXPECT_EQ(parser->store().get("--time").to<int>(), 5);
+    const char *missing[] = {"./argtest", "lock", "-T", "2"};
+    EXPECT_FALSE(parser->parse(4, missing));
+    const char *root[] = {"./argtest", "-t", "5"};
+    EXPECT_FALSE(parser->parse(3, root));
+    EXPECT_NE(lock.help().find("Run Flags:"), std::string::npos);
+
+    auto frozen = parser->freeze();
+    argparser::ParseResult result;
+    EXPECT_TRUE(frozen.parse(6, cas_arg, result));
+    EXPECT_EQ(result.get("-T").to<int64_t>(), 4);
+    EXPECT_TRUE(frozen.parse(5, lock_arg, result));
+    EXPECT_EQ(result.get("--time").to<int>(), 5);
+    EXPECT_FALSE(frozen.parse(4, missing, result));
+}
+TEST(ArgparserCommand, ShouldBuildLazyCommandsOnDemand)
+{
+    int64_t threads = 0;
+    size_t nr_built = 0;
+    auto parser = argparser::new_parser();
+    parser->command("run", "Run the program");
+    EXPECT_TRUE(parser->command(
+        "bench", "Run the benchmark", [&](argparser::Parser &bench) {
+            nr_built++;
+            EXPECT_TRUE(bench.flag(&threads, "--threads", "-T", "", "1"));
+            bench.command("cas", "Compare and swap");
+        }));
+    EXPECT_FALSE(parser->command("bench", "", [](argparser::Parser &) {}));
+    EXPECT_FALSE(parser->command("run", "", [](argparser::Parser &) {}));
+
+    const char *run[] = {"./argtest", "run"};
+    EXPECT_TRUE(parser->parse(2, run));
+    auto help = parser->help();
+    EXPECT_NE(help.find("Run the benchmark"), std::string::npos);
+    EXPECT_EQ(nr_built, 0);
+    EXPECT_EQ(threads, 0);
+
+    const char *bench[] = {"./argtest", "bench", "-T", "4", "cas"};
+    EXPECT_TRUE(parser->parse(5, bench));
+    EXPECT_EQ(nr_built, 1);
+    EXPECT_EQ(threads, 4);
+    EXPECT_EQ(parser->command_path(),
+              std::vector<std::string>({"bench", "cas"}));
+    const char *none[] = {"./argtest", "bench"};
+    EXPECT_TRUE(parser->parse(2, none));
+    EXPECT_EQ(nr_built, 1);
+    EXPECT_EQ(threads, 1);
+    EXPECT_EQ(&parser->command("bench").command("cas"),
+              &parser->command("bench").command("cas"));
+    EXPECT_EQ(nr_built, 1);
+}
+TEST(ArgparserCommand, ShouldBuildLazyCommandsForHelpAndFreeze)
+{
+    size_t nr_built = 0;
+    auto factory = [&nr_built](argparser::Parser &sub) {
+        nr_built++;
+        EXPECT_TRUE(sub.flag("--size", "-S", "The size of the IO", "4k"));
+    };
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->command("read", "", factory));
+    EXPECT_TRUE(parser->command("write", "", factory));
+
+    const char *help[] = {"./argtest", "read"};
+    EXPECT_TRUE(parser->parse(2, help));
+    testing::internal::CaptureStdout();
+    parser->print_promt(2, help);
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_NE(out.find("The size of the IO"), std::string::npos);
+    EXPECT_EQ(nr_built, 1);
+
+    auto frozen = parser->freeze();
+    EXPECT_EQ(nr_built, 2);
+    argparser::ParseResult result;
+    const char *arg[] = {"./argtest", "write", "-S", "1M"};
+    EXPECT_TRUE(frozen.parse(4, arg, result));
+    EXPECT_EQ(result.get("--size").to<std::string>(), "1M");
+}
+TEST(ArgparserCommand, ShouldMatchPrefixesOfFlagSets)
+{
+    auto set = argparser::new_flag_set("Run Flags");
+    EXPECT_TRUE(set->flag("--threads", "-T", "The number of threads"));
+    EXPECT_TRUE(set->flag("--batch", "-b", "The batch size", "1"));
+    auto parser = argparser::new_parser();
+    auto &run = parser->command("run", "");
+    EXPECT_TRUE(run.use(set));
+    EXPECT_TRUE(run.flag("--threads-max", "", "", "64"));
+    parser->allow_prefix();
+
+    EXPECT_EQ(run.complete("--t"),
+              std::vector<std::string>({"--threads", "--threads-max"}));
+    const char *ambiguous[] = {"./argtest", "run", "--thre", "4"};
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(parser->parse(4, ambiguous));
+    auto err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("ambiguous among [--threads, --threads-max, ]"),
+              std::string::npos);
+
+    const char *prefix[] = {
+        "./argtest", "run", "--threads", "4", "--bat", "8", "--threads-m", "2"};
+    EXPECT_TRUE(parser->parse(8, prefix));
+    EXPECT_EQ(parser->store().get("--batch").to<int>(), 8);
+    EXPECT_EQ(parser->store().get("--threads-max").to<int>(), 2);
+
+    const char *typo[] = {"./argtest", "run", "--threads", "4", "--batsh", "8"};
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(parser->parse(6, typo));
+    err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("Did you mean \"--batch\"?"), std::string::npos);
+}
+TEST(ArgparserCommand, ShouldRejectFlagSetsUsedAboveOrBelow)
+{
+    auto set = argparser::new_flag_set("Run Flags");
+    EXPECT_TRUE(set->flag("--threads", "-T", "", "1"));
+    auto parser = argparser::new_parser();
+    auto &run = parser->command("run", "");
+    auto &quick = run.command("quick", "");
+    auto &bench = parser->command("bench", "");
+    EXPECT_TRUE(run.use(set));
+    EXPECT_TRUE(bench.use(set));
+
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(quick.use(set));
+    EXPECT_FALSE(parser->use(set));
+    auto err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("already used by an enclosing command"),
+              std::string::npos);
+    EXPECT_NE(err.find("already used by a sub-command"), std::string::npos);
+
+    // a lazy command checks its enclosing commands once built
+    EXPECT_TRUE(run.command("lazy", "", [&](argparser::Parser &lazy) {
+        EXPECT_FALSE(lazy.use(set));
+    }));
+    const char *arg[] = {"./argtest", "run", "-T", "4", "lazy"};
+    EXPECT_TRUE(parser->parse(5, arg));
+}
+TEST(ArgparserCommand, ShouldRejectGlobalFlagsOfLazyCommands)
+{
+    bool verbose = false;
+    int64_t threads = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->global_flag(&verbose, "--verbose", "-v", "", "0"));
+    EXPECT_TRUE(parser->command(
+        "bench", "", [&](argparser::Parser &bench) {
+            EXPECT_FALSE(bench.global_flag(&threads, "--gthreads", "", ""));
+            auto &quick = bench.command("quick", "");
+            EXPECT_FALSE(quick.global_flag("--gname", "", "", "x"));
+            EXPECT_TRUE(quick.flag(&threads, "--threads", "-T", "", "1"));
+        }));
+
+    const char *arg[] = {"./argtest", "-v", "1", "bench", "quick", "-T", "2"};
+    EXPECT_TRUE(parser->parse(7, arg));
+    EXPECT_TRUE(verbose);
+    EXPECT_EQ(threads, 2);
+    const char *global[] = {"./argtest", "--gname", "y", "bench"};
+    EXPECT_FALSE(parser->parse(4, global));
+}
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -638,6 +638,44 @@ TEST(ArgparserFlagStore, StoreShouldRecognizeBothShortAndFullName)
     EXPECT_EQ(t, 10);
 }
 
+TEST(ArgparserFlagStore, LookupAmongManyFlags)
+{
+    constexpr size_t kFlagNr = 5000;
+    auto parser = argparser::new_parser();
+    std::vector<int64_t> values(kFlagNr);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < kFlagNr; ++i)
+    {
+        names.push_back("--flag-" + std::to_string(i));
+    }
+    for (size_t i = 0; i < kFlagNr; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            EXPECT_TRUE(parser->flag(&values[i], names[i].c_str(), "", "", "0"));
+        }
+        else
+        {
+            EXPECT_TRUE(parser->flag(names[i].c_str(), "", "", "0"));
+        }
+    }
+    EXPECT_TRUE(parser->flag("--last", "-l", "The last flag"));
+    const char *arg[] = {
+        "./argtest", "--flag-4998", "42", "--flag-4999=43", "-l", "44"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+
+    auto &store = parser->store();
+    EXPECT_EQ(values[4998], 42);
+    EXPECT_EQ(values[0], 0);
+    EXPECT_FALSE(store.has("--flag-4998"));
+    ASSERT_TRUE(store.has("--flag-4999"));
+    EXPECT_EQ(store.get("--flag-4999").to<int>(), 43);
+    EXPECT_EQ(store.get("--flag-1").to<int>(), 0);
+    EXPECT_EQ(store.get("--last").to<int>(), 44);
+    EXPECT_FALSE(store.has("--flag-5000"));
+    EXPECT_FALSE(store.has(""));
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
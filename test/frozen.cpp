@@ -0,0 +1,295 @@
+#include <inttypes.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+TEST(ArgparserFrozen, ShouldParseRepeatedly)
+{
+    int64_t i;
+    std::string s;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "1"));
+    EXPECT_TRUE(parser->flag(&s, "--str", "-s", "", "default"));
+    EXPECT_TRUE(parser->flag("--name", "-n", "", "anonymous"));
+    auto frozen = parser->freeze();
+    EXPECT_EQ(frozen.command_nr(), 1);
+    EXPECT_EQ(frozen.flag_nr(), 3);
+
+    const char *arg[] = {"./argtest", "-i", "5", "--str", "hi", "-n", "foo"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(i, 5);
+    EXPECT_EQ(s, "hi");
+    EXPECT_EQ(frozen.get("--name").to<std::string>(), "foo");
+
+    // the flags not given again go back to their defaults
+    const char *arg2[] = {"./argtest", "--int", "7"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(i, 7);
+    EXPECT_EQ(s, "default");
+    EXPECT_EQ(frozen.get("-n").to<std::string>(), "anonymous");
+}
+
+TEST(ArgparserFrozen, ShouldParseCommand)
+{
+    int64_t root_i;
+    int64_t i;
+    bool verbose;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&root_i, "--i", "", "", "0"));
+    EXPECT_TRUE(parser->global_flag(&verbose, "--verbose", "-v", "", "0"));
+    auto &start = parser->command("start");
+    EXPECT_TRUE(start.flag(&i, "--i", "", "", "0"));
+    auto &now = start.command("now");
+    EXPECT_TRUE(now.flag("--at", "", ""));
+    auto frozen = parser->freeze();
+    EXPECT_EQ(frozen.command_nr(), 3);
+
+    const char *arg[] = {
+        "./argtest", "start", "--i", "2", "now", "--at", "9", "-v"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(root_i, 0);
+    EXPECT_EQ(i, 2);
+    EXPECT_TRUE(verbose);
+    EXPECT_EQ(frozen.command_path(),
+              std::vector<std::string>({"start", "now"}));
+    EXPECT_TRUE(frozen.has("--at"));
+    EXPECT_EQ(frozen.get("--at").to<int>(), 9);
+
+    const char *arg2[] = {"./argtest", "--i", "3"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(root_i, 3);
+    EXPECT_FALSE(verbose);
+    EXPECT_TRUE(frozen.command_path().empty());
+    EXPECT_FALSE(frozen.has("--at"));
+}
+
+TEST(ArgparserFrozen, ShouldFailForBadInput)
+{
+    int64_t i;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", ""));
+    parser->command("start");
+    auto frozen = parser->freeze();
+
+    const char *missing[] = {"./argtest"};
+    EXPECT_FALSE(frozen.parse(1, missing));
+    const char *twice[] = {"./argtest", "-i", "1", "--int", "2"};
+    EXPECT_FALSE(frozen.parse(sizeof(twice) / sizeof(twice[0]), twice));
+    const char *unknown[] = {"./argtest", "stop", "-i", "1"};
+    EXPECT_FALSE(frozen.parse(sizeof(unknown) / sizeof(unknown[0]), unknown));
+    const char *bad[] = {"./argtest", "-i", "one"};
+    EXPECT_FALSE(frozen.parse(sizeof(bad) / sizeof(bad[0]), bad));
+    // a failed parse does not poison the next one
+    const char *good[] = {"./argtest", "-i", "1"};
+    EXPECT_TRUE(frozen.parse(sizeof(good) / sizeof(good[0]), good));
+    EXPECT_EQ(i, 1);
+}
+
+TEST(ArgparserFrozen, ResultsAreIndependent)
+{
+    int64_t i = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "1"));
+    EXPECT_TRUE(parser->flag("--name", "-n", ""));
+    auto &start = parser->command("start");
+    EXPECT_TRUE(start.flag("--at", "", "", "now"));
+    const auto frozen = parser->freeze();
+
+    argparser::ParseResult first;
+    argparser::ParseResult second;
+    const char *arg[] = {"./argtest", "-i", "5", "-n", "foo"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg, first));
+    const char *arg2[] = {"./argtest", "-n", "bar", "start", "--at", "9"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg2) / sizeof(arg2[0]), arg2, second));
+
+    // the typed variable is not written, the value is in the result
+    EXPECT_EQ(i, 0);
+    EXPECT_EQ(first.get("--int").to<int>(), 5);
+    EXPECT_EQ(first.get("--name").to<std::string>(), "foo");
+    EXPECT_TRUE(first.command_path().empty());
+    EXPECT_EQ(second.get("--at").to<int>(), 9);
+    EXPECT_EQ(second.command_path(), std::vector<std::string>({"start"}));
+
+    const char *arg3[] = {"./argtest", "-n", "baz"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg3) / sizeof(arg3[0]), arg3, first));
+    EXPECT_EQ(first.get("--int").to<int>(), 1);
+    EXPECT_EQ(first.get("--name").to<std::string>(), "baz");
+}
+
+TEST(ArgparserFrozen, ShouldParseConcurrently)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--id", "", ""));
+    const auto frozen = parser->freeze();
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&frozen, &failures, t]() {
+            argparser::ParseResult result;
+            for (int n = 0; n < 1000; ++n)
+            {
+                auto id = std::to_string(t * 1000 + n);
+                const char *arg[] = {"./argtest", "--id", id.c_str()};
+                if (!frozen.parse(3, arg, result) ||
+                    result.get("--id").to<int>() != t * 1000 + n)
+                {
+                    failures[t]++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(failures, std::vector<int>(4, 0));
+}
+
+struct Config
+{
+    int64_t threads{0};
+    std::string name;
+    std::vector<int> ports;
+};
+
+TEST(ArgparserFrozen, ShouldParseIntoMembers)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&Config::threads, "--threads", "-t", ""));
+    EXPECT_TRUE(parser->flag(&Config::name, "--name", "-n", "", "job"));
+    EXPECT_TRUE(parser->flag(&Config::ports, "--ports", "-p", "", "80"));
+    EXPECT_FALSE(parser->flag(&Config::threads, "--bad", "", "", "many"));
+    const auto frozen = parser->freeze();
+
+    std::vector<Config> configs(64);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&frozen, &configs, t]() {
+            argparser::ParseResult result;
+            for (size_t n = t; n < configs.size(); n += 4)
+            {
+                auto nr = std::to_string(n);
+                const char *arg[] = {"./argtest", "-t", nr.c_str()};
+                frozen.parse(3, arg, configs[n], result);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (size_t n = 0; n < configs.size(); ++n)
+    {
+        EXPECT_EQ(configs[n].threads, static_cast<int64_t>(n));
+        EXPECT_EQ(configs[n].name, "job");
+        EXPECT_EQ(configs[n].ports, std::vector<int>({80}));
+    }
+
+    Config config;
+    const char *arg[] = {"./argtest", "-t", "2", "-n", "x", "-p", "1,2"};
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg, config));
+    EXPECT_EQ(config.threads, 2);
+    EXPECT_EQ(config.name, "x");
+    EXPECT_EQ(config.ports, std::vector<int>({1, 2}));
+
+    const char *missing[] = {"./argtest", "-n", "x"};
+    EXPECT_FALSE(frozen.parse(3, missing, config));
+    const char *bad[] = {"./argtest", "-t", "x"};
+    EXPECT_FALSE(frozen.parse(3, bad, config));
+}
+
+TEST(ArgparserFrozen, ShouldParseMembersOfEnteredCommandsOnly)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&Config::name, "--name", "-n", "", "root"));
+    auto &run = parser->command("run", "");
+    EXPECT_TRUE(run.flag(&Config::threads, "--threads", "-t", "", "1"));
+    auto &bench = parser->command("bench", "");
+    EXPECT_TRUE(bench.flag(&Config::threads, "--threads", "-t", "", "8"));
+    auto &quick = bench.command("quick", "");
+    EXPECT_TRUE(quick.flag(&Config::name, "--name", "-n", "", "quick"));
+    const auto frozen = parser->freeze();
+
+    Config config;
+    const char *arg1[] = {"./argtest", "bench"};
+    EXPECT_TRUE(frozen.parse(2, arg1, config));
+    EXPECT_EQ(config.threads, 8);
+    EXPECT_EQ(config.name, "root");
+
+    config = Config();
+    const char *arg2[] = {"./argtest", "run"};
+    EXPECT_TRUE(frozen.parse(2, arg2, config));
+    EXPECT_EQ(config.threads, 1);
+
+    // the deepest command is written last
+    config = Config();
+    const char *arg3[] = {"./argtest", "bench", "-t", "4", "quick"};
+    EXPECT_TRUE(frozen.parse(5, arg3, config));
+    EXPECT_EQ(config.threads, 4);
+    EXPECT_EQ(config.name, "quick");
+
+    config = Config();
+    const char *arg4[] = {"./argtest"};
+    EXPECT_TRUE(frozen.parse(1, arg4, config));
+    EXPECT_EQ(config.threads, 0);
+    EXPECT_EQ(config.name, "root");
+}
+
+TEST(ArgparserFrozen, ShouldCheckFlagGroups)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--verbose", "-v", "", "false"));
+    auto &run = parser->command("run", "");
+    EXPECT_TRUE(run.flag("--json", "", "", "false"));
+    EXPECT_TRUE(run.flag("--yaml", "", "", "false"));
+    EXPECT_TRUE(run.flag("--file", "-f", ""));
+    EXPECT_TRUE(run.mutually_exclusive({"--json", "--yaml"}));
+    auto frozen = parser->freeze();
+
+    argparser::ParseResult result;
+    const char *root[] = {"./argtest", "-v", "true"};
+    EXPECT_TRUE(frozen.parse(3, root, result));
+    const char *one[] = {"./argtest", "run", "-f", "a", "--json", "true"};
+    EXPECT_TRUE(frozen.parse(6, one, result));
+    const char *both[] = {
+        "./argtest", "run", "-f", "a", "--json", "true", "--yaml", "true"};
+    EXPECT_FALSE(frozen.parse(8, both, result));
+    const char *missing[] = {"./argtest", "run", "--yaml", "true"};
+    EXPECT_FALSE(frozen.parse(4, missing, result));
+}
+
+TEST(ArgparserFrozen, ShouldParseShortBundle)
+{
+    bool v = false;
+    int64_t threads = 0;
+    auto parser = argparser::new_parser();
+    auto &run = parser->command("run", "");
+    EXPECT_TRUE(run.flag(&v, "--verbose", "-v", "", "false"));
+    EXPECT_TRUE(run.flag(&threads, "--threads", "-T", "", "1"));
+    EXPECT_TRUE(run.flag("--file", "-f", "", "none"));
+    auto frozen = parser->freeze();
+
+    argparser::ParseResult result;
+    const char *bundle[] = {"./argtest", "run", "-vT8", "-f", "a"};
+    EXPECT_TRUE(frozen.parse(5, bundle, result));
+    EXPECT_TRUE(result.has("-v"));
+    EXPECT_EQ(result.get("-T").to<int64_t>(), 8);
+    EXPECT_EQ(result.get("-f").to<std::string>(), "a");
+
+    const char *detached[] = {"./argtest", "run", "-vT", "4"};
+    EXPECT_TRUE(frozen.parse(4, detached, result));
+    EXPECT_EQ(result.get("-T").to<int64_t>(), 4);
+
+    // the flags of run are not flags of the root
+    const char *scope[] = {"./argtest", "-vT2", "run"};
+    EXPECT_FALSE(frozen.parse(3, scope, result));
+    const char *twice[] = {"./argtest", "run", "-vv"};
+    EXPECT_FALSE(frozen.parse(3, twice, result));
+}
@@ -0,0 +1,136 @@
+#include <inttypes.h>
+
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+// the defaults are validated at registration unless turned off
+
+struct Counted
+{
+    int64_t value{0};
+};
+static size_t nr_conversions = 0;
+template <>
+std::optional<Counted> argparse::convert::try_to<Counted>(
+    const std::string &input)
+{
+    nr_conversions++;
+    auto maybe = try_to<int64_t>(input);
+    if (!maybe.has_value())
+    {
+        return std::nullopt;
+    }
+    return Counted{maybe.value()};
+}
+
+TEST(ArgparserLazyDefaults, ShouldConvertOnlyUnappliedDefaults)
+{
+    std::vector<Counted> values(100);
+    std::vector<std::string> names;
+    auto parser = argparser::new_parser();
+    parser->validate_defaults(false);
+    nr_conversions = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        names.push_back("--f" + std::to_string(i));
+        EXPECT_TRUE(parser->flag(&values[i], names[i].c_str(), "", "", "7"));
+    }
+    EXPECT_EQ(nr_conversions, 0);
+    EXPECT_EQ(values[0].value, 0);
+
+    // every flag given: no default is converted
+    std::vector<const char *> arg{"./argtest"};
+    for (const auto &name : names)
+    {
+        arg.push_back(name.c_str());
+        arg.push_back("1");
+    }
+    EXPECT_TRUE(parser->parse(arg.size(), arg.data()));
+    EXPECT_EQ(nr_conversions, values.size());
+    EXPECT_EQ(values[99].value, 1);
+
+    // no flag given: every default once, and never again
+    const char *none[] = {"./argtest"};
+    nr_conversions = 0;
+    EXPECT_TRUE(parser->parse(1, none));
+    EXPECT_EQ(nr_conversions, values.size());
+    EXPECT_EQ(values[99].value, 7);
+    nr_conversions = 0;
+    EXPECT_TRUE(parser->parse(1, none));
+    EXPECT_EQ(nr_conversions, 0);
+
+    // only the flag given last time goes back to its default
+    const char *one[] = {"./argtest", "--f3", "5"};
+    EXPECT_TRUE(parser->parse(3, one));
+    EXPECT_EQ(values[3].value, 5);
+    nr_conversions = 0;
+    EXPECT_TRUE(parser->parse(1, none));
+    EXPECT_EQ(nr_conversions, 1);
+    EXPECT_EQ(values[3].value, 7);
+}
+
+TEST(ArgparserLazyDefaults, ShouldReportMalformedDefaultsWhenParsed)
+{
+    int64_t i = 0;
+    auto parser = argparser::new_parser();
+    parser->validate_defaults(false);
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "many"));
+    EXPECT_TRUE(parser->flag("--name", "-n", "", "anonymous"));
+
+    const char *given[] = {"./argtest", "-i", "3"};
+    EXPECT_TRUE(parser->parse(3, given));
+    EXPECT_EQ(i, 3);
+    EXPECT_EQ(parser->store().get("-n").to<std::string>(), "anonymous");
+
+    const char *none[] = {"./argtest"};
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(parser->parse(1, none));
+    auto err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("default value \"many\" not parsable"),
+              std::string::npos);
+}
+
+TEST(ArgparserLazyDefaults, ShouldValidateDefaultsByDefault)
+{
+    int64_t i = 0;
+    auto parser = argparser::new_parser();
+    auto &run = parser->command("run", "");
+    auto set = argparser::new_flag_set("Shared");
+    EXPECT_TRUE(parser->use(set));
+    EXPECT_FALSE(parser->flag(&i, "--int", "-i", "", "many"));
+    EXPECT_FALSE(run.flag(&i, "--int", "-i", "", "many"));
+    EXPECT_FALSE(parser->global_flag(&i, "--global", "-g", "", "many"));
+    EXPECT_FALSE(set->flag(&i, "--shared", "", "", "many"));
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "1"));
+
+    // turned off for the commands and the sets, used before or after
+    parser->validate_defaults(false);
+    auto &bench = parser->command("bench", "");
+    auto later = argparser::new_flag_set("Later");
+    EXPECT_TRUE(bench.use(later));
+    EXPECT_TRUE(run.flag(&i, "--int", "-i", "", "many"));
+    EXPECT_TRUE(bench.flag(&i, "--int", "-i", "", "many"));
+    EXPECT_TRUE(set->flag(&i, "--shared", "", "", "many"));
+    EXPECT_TRUE(later->flag(&i, "--later", "", "", "many"));
+}
+
+TEST(ArgparserLazyDefaults, ShouldWriteDefaultsWhenFrozen)
+{
+    int64_t i = 0;
+    std::string s;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "1"));
+    EXPECT_TRUE(parser->flag(&s, "--str", "-s", "", "default"));
+    auto frozen = parser->freeze();
+
+    const char *arg[] = {"./argtest", "-i", "5"};
+    EXPECT_TRUE(frozen.parse(3, arg));
+    EXPECT_EQ(i, 5);
+    EXPECT_EQ(s, "default");
+    const char *none[] = {"./argtest"};
+    EXPECT_TRUE(frozen.parse(1, none));
+    EXPECT_EQ(i, 1);
+}
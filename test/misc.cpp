@@ -1,5 +1,8 @@
 #include <inttypes.h>
 
+#include <string>
+#include <vector>
+
 #include "argparser/argparser.hpp"
 #include "gtest/gtest.h"
 
@@ -55,6 +58,24 @@ TEST(ArgparserFlag, CanOverrideDefaultValue)
     EXPECT_EQ(required, 2);
 }
 
+TEST(ArgparserFlag, CanParseAgain)
+{
+    int required = 1;
+    int optional = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(
+        parser->flag(&required, "--required", "-r", "A required number"));
+    EXPECT_TRUE(parser->flag(
+        &optional, "--optional", "-o", "An optional number", "181"));
+    const char *arg[] = {"./argtest", "--optional", "284", "--required", "2"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(optional, 284);
+    const char *arg2[] = {"./argtest", "--required", "3"};
+    EXPECT_TRUE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(required, 3);
+    EXPECT_EQ(optional, 181);
+}
+
 TEST(ArgparserFlag, NotAllowDupFullFlag)
 {
     int required = 1;
@@ -248,6 +269,114 @@ TEST(ArgparserFlag, FlagThatFailedToRegisterShouldNotExists4)
     const char *arg[] = {"./argtest", "abc", "4"};
     EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
 }
+TEST(ArgparserFlag, RequiredFlagsBeyondOneWord)
+{
+    // more required flags than the bits of one word
+    std::vector<std::string> names;
+    std::vector<int> values(100);
+    auto parser = argparser::new_parser();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        names.push_back("--f" + std::to_string(i));
+        EXPECT_TRUE(parser->flag(&values[i], names[i].c_str(), "", ""));
+    }
+    std::vector<const char *> arg{"./argtest"};
+    for (const auto &name : names)
+    {
+        arg.push_back(name.c_str());
+        arg.push_back("1");
+    }
+    EXPECT_TRUE(parser->parse(arg.size(), arg.data()));
+    // drop --f99
+    EXPECT_FALSE(parser->parse(arg.size() - 2, arg.data()));
+    arg.erase(arg.begin() + 1, arg.begin() + 3);
+    // drop --f0
+    EXPECT_FALSE(parser->parse(arg.size(), arg.data()));
+}
+TEST(ArgparserFlag, FlagGroups)
+{
+    bool json = false;
+    bool yaml = false;
+    std::string user;
+    std::string password;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&json, "--json", "", "", "false"));
+    EXPECT_TRUE(parser->flag(&yaml, "--yaml", "", "", "false"));
+    EXPECT_TRUE(parser->flag(&user, "--user", "-u", "", ""));
+    EXPECT_TRUE(parser->flag(&password, "--password", "-p", "", ""));
+    EXPECT_TRUE(parser->mutually_exclusive({"--json", "--yaml"}));
+    EXPECT_TRUE(parser->all_or_none({"-u", "--password"}));
+    EXPECT_FALSE(parser->at_least_one({"--json", "--xml"}));
+
+    const char *none[] = {"./argtest"};
+    EXPECT_TRUE(parser->parse(1, none));
+    const char *one[] = {"./argtest", "--json", "true"};
+    EXPECT_TRUE(parser->parse(3, one));
+    const char *both[] = {"./argtest", "--json", "true", "--yaml", "true"};
+    EXPECT_FALSE(parser->parse(5, both));
+    const char *half[] = {"./argtest", "-u", "me"};
+    EXPECT_FALSE(parser->parse(3, half));
+    const char *all[] = {"./argtest", "-u", "me", "-p", "secret"};
+    EXPECT_TRUE(parser->parse(5, all));
+
+    EXPECT_TRUE(parser->at_least_one({"--json", "--yaml"}));
+    EXPECT_FALSE(parser->parse(1, none));
+    EXPECT_TRUE(parser->parse(3, one));
+}
+
+TEST(ArgparserTokenizer, TokensPointIntoArgv)
+{
+    const char *arg[] = {"./argtest",
+                         "run",
+                         "--time",
+                         "5",
+                         "--size=4k",
+                         "-f",
+                         "--array=",
+                         "-n",
+                         "-5"};
+    auto tokens = argparser::tokenize(sizeof(arg) / sizeof(arg[0]), arg);
+    ASSERT_EQ(tokens.size(), 6);
+    EXPECT_EQ(tokens[0].key, "run");
+    EXPECT_TRUE(tokens[0].value.empty());
+    EXPECT_EQ(tokens[1].key, "--time");
+    EXPECT_EQ(tokens[1].value, "5");
+    EXPECT_EQ(tokens[1].value.data(), arg[3]);
+    EXPECT_EQ(tokens[2].key, "--size");
+    EXPECT_EQ(tokens[2].value, "4k");
+    EXPECT_EQ(tokens[2].key.data(), arg[4]);
+    EXPECT_EQ(tokens[3].key, "-f");
+    EXPECT_TRUE(tokens[3].value.empty());
+    EXPECT_EQ(tokens[4].key, "--array");
+    EXPECT_TRUE(tokens[4].value.empty());
+    EXPECT_EQ(tokens[5].key, "-n");
+    EXPECT_EQ(tokens[5].value, "-5");
+}
+
+TEST(ArgparserHelp, HelpIsWrapped)
+{
+    auto parser = argparser::new_parser("A command-line tool");
+    auto &run = parser->command("run", argparser::very_long_sentence);
+    EXPECT_TRUE(run.flag("--time", "-t", "The time to run"));
+    EXPECT_TRUE(parser->flag("--size", "-S", argparser::long_sentence, "0"));
+
+    auto help = parser->help();
+    EXPECT_EQ(help.find("A command-line tool\n\n"), 0);
+    EXPECT_NE(help.find("Available Commands:\n  run  Hello,"),
+              std::string::npos);
+    EXPECT_NE(help.find("Flags:\n  -S, --size\n"), std::string::npos);
+    EXPECT_EQ(help.find("--time"), std::string::npos);
+
+    // every word is kept and no line exceeds the layout width
+    std::istringstream iss(help);
+    std::string line;
+    while (std::getline(iss, line))
+    {
+        // the flag column is "  -S, --size  "
+        EXPECT_LE(line.size(), 2 + 2 + 2 + 6 + 2 + 80) << line;
+    }
+    EXPECT_NE(help.find("language."), std::string::npos);
+}
 
 int main(int argc, char **argv)
 {
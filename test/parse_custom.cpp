@@ -206,6 +206,114 @@ TEST(ArgparserFlag, EnumCanParsedRegistered)
     EXPECT_EQ(c, Color::kRed);
 }
 
+enum class Shape
+{
+    kCircle,
+    kSquare,
+    kTriangle,
+};
+ARGPARSER_ENUM(Shape,
+               {"circle", Shape::kCircle},
+               {"square", Shape::kSquare},
+               {"triangle", Shape::kTriangle});
+static_assert(argparse::convert::Enum<Shape>::find("square") == Shape::kSquare);
+static_assert(!argparse::convert::Enum<Shape>::find("Square").has_value());
+TEST(ArgparserFlag, EnumTableCanParsed)
+{
+    Shape shape;
+    std::vector<Shape> shapes;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&shape, "--shape", "-s", "The shape", "circle"));
+    EXPECT_TRUE(parser->flag(&shapes, "--shapes", "", "The shapes", ""));
+    EXPECT_TRUE(parser->flag("--stored", "", "A stored shape", "triangle"));
+
+    const char *arg[] = {
+        "./argtest", "-s", "square", "--shapes", "triangle,circle"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(shape, Shape::kSquare);
+    EXPECT_EQ(shapes, std::vector<Shape>({Shape::kTriangle, Shape::kCircle}));
+    EXPECT_EQ(parser->store().get("--stored").to<Shape>(), Shape::kTriangle);
+
+    const char *none[] = {"./argtest"};
+    EXPECT_TRUE(parser->parse(sizeof(none) / sizeof(none[0]), none));
+    EXPECT_EQ(shape, Shape::kCircle);
+
+    auto help = parser->help();
+    EXPECT_NE(help.find("choices: circle, square, triangle"),
+              std::string::npos);
+}
+TEST(ArgparserFlag, EnumTableShouldSuggest)
+{
+    Shape shape;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&shape, "--shape", "-s", "The shape", "circle"));
+
+    const char *arg[] = {"./argtest", "-s", "Sqaure"};
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    auto err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("did you mean \"square\"?"), std::string::npos);
+
+    const char *arg2[] = {"./argtest", "-s", "hexagon"};
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    err = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(err.find("did you mean"), std::string::npos);
+}
+
+struct Counted
+{
+    int64_t value;
+};
+static size_t counted_conversions = 0;
+template <>
+std::optional<Counted> argparse::convert::try_to(const std::string &input)
+{
+    counted_conversions++;
+    auto maybe = try_to<int64_t>(input);
+    if (!maybe.has_value())
+    {
+        return {};
+    }
+    return Counted{maybe.value()};
+}
+TEST(ArgparserFlag, ConversionIsCachedPerType)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--counted", "-c", "A counted flag", "1"));
+    auto &store = parser->store();
+
+    counted_conversions = 0;
+    EXPECT_TRUE(store.get("--counted").convertable_to<Counted>());
+    EXPECT_EQ(store.get("--counted").to<Counted>().value, 1);
+    EXPECT_EQ(store.get("-c").to<Counted>().value, 1);
+    EXPECT_EQ(store.get("--counted").to<int>(), 1);
+    EXPECT_EQ(counted_conversions, 1);
+
+    // applying the flag again drops the cached values
+    const char *arg[] = {"./argtest", "--counted", "2"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(store.get("--counted").to<Counted>().value, 2);
+    EXPECT_EQ(store.get("--counted").to<int>(), 2);
+    EXPECT_EQ(counted_conversions, 2);
+}
+TEST(ArgparserFlag, FailedConversionIsCached)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--counted", "-c", "A counted flag", "abc"));
+    auto &store = parser->store();
+
+    counted_conversions = 0;
+    EXPECT_FALSE(store.get("--counted").convertable_to<Counted>());
+    EXPECT_FALSE(store.get("--counted").convertable_to<Counted>());
+    EXPECT_EQ(counted_conversions, 1);
+
+    // a copy does not share the cache of the original
+    auto copy = store.get("--counted");
+    EXPECT_FALSE(copy.convertable_to<Counted>());
+    EXPECT_EQ(counted_conversions, 2);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,9 @@
 #include <inttypes.h>
 
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "argparser/argparser.hpp"
 #include "gtest/gtest.h"
 
@@ -395,6 +399,155 @@ TEST(ArgparserFlag, ParseArrayFailedAtMiddle2)
     EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
 }
 
+TEST(ArgparserFlag, ParseIntOutOfRange)
+{
+    int32_t i = 0;
+    int64_t i64 = 0;
+    uint8_t u8 = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", "", "0"));
+    EXPECT_TRUE(parser->flag(&i64, "--int64", "-l", "", "0"));
+    EXPECT_TRUE(parser->flag(&u8, "--uint8", "-u", "", "0"));
+    const char *arg1[] = {"./argtest", "--int", "2147483648"};
+    EXPECT_FALSE(parser->parse(sizeof(arg1) / sizeof(arg1[0]), arg1));
+
+    parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i64, "--int64", "-l", "", "0"));
+    const char *arg2[] = {"./argtest", "--int64", "9223372036854775808"};
+    EXPECT_FALSE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+
+    parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&u8, "--uint8", "-u", "", "0"));
+    const char *arg3[] = {"./argtest", "--uint8", "256"};
+    EXPECT_FALSE(parser->parse(sizeof(arg3) / sizeof(arg3[0]), arg3));
+}
+
+TEST(ArgparserFlag, ParseInt8AsInteger)
+{
+    uint8_t u8 = 1;
+    int8_t i8 = 1;
+    char c = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&u8, "--uint8", "-u", "", "0"));
+    EXPECT_TRUE(parser->flag(&i8, "--int8", "-i", "", "0"));
+    EXPECT_TRUE(parser->flag(&c, "--char", "-c", "", "x"));
+    const char *arg1[] = {"./argtest"};
+    EXPECT_TRUE(parser->parse(sizeof(arg1) / sizeof(arg1[0]), arg1));
+    EXPECT_EQ(u8, 0);
+    EXPECT_EQ(i8, 0);
+    EXPECT_EQ(c, 'x');
+
+    const char *arg2[] = {
+        "./argtest", "--uint8", "255", "--int8", "-128", "--char", "7"};
+    EXPECT_TRUE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(u8, 255);
+    EXPECT_EQ(i8, -128);
+    EXPECT_EQ(c, '7');
+
+    const char *arg3[] = {"./argtest", "--uint8", "12"};
+    EXPECT_TRUE(parser->parse(sizeof(arg3) / sizeof(arg3[0]), arg3));
+    EXPECT_EQ(u8, 12);
+
+    const char *arg4[] = {"./argtest", "--int8", "128"};
+    EXPECT_FALSE(parser->parse(sizeof(arg4) / sizeof(arg4[0]), arg4));
+    const char *arg5[] = {"./argtest", "--uint8", "1000"};
+    EXPECT_FALSE(parser->parse(sizeof(arg5) / sizeof(arg5[0]), arg5));
+}
+
+TEST(ArgparserFlag, ParseNumberWithSign)
+{
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", ""));
+    EXPECT_TRUE(parser->flag(&u, "--uint", "-u", ""));
+    EXPECT_TRUE(parser->flag(&d, "--double", "-d", ""));
+    // a negative unsigned number wraps around, as std::istream does.
+    const char *arg[] = {
+        "./argtest", "--int", "+5", "--uint", "-1", "--double", "+.5"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(i, 5);
+    EXPECT_EQ(u, std::numeric_limits<uint64_t>::max());
+    EXPECT_DOUBLE_EQ(d, 0.5);
+
+    parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&i, "--int", "-i", ""));
+    const char *arg2[] = {"./argtest", "--int", "+-5"};
+    EXPECT_FALSE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+}
+
+TEST(ArgparserFlag, ParseDoubleShouldFailForNonFinite)
+{
+    for (const char *value : {"inf", "-inf", "nan", "1e999", "0x10", "1.5e"})
+    {
+        double d = 0;
+        auto parser = argparser::new_parser();
+        EXPECT_TRUE(parser->flag(&d, "--double", "-d", ""));
+        const char *arg[] = {"./argtest", "--double", value};
+        EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg))
+            << value;
+    }
+}
+
+TEST(ArgparserFlag, ParseShortBundle)
+{
+    bool v = false;
+    bool x = false;
+    int64_t threads = 0;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&v, "--verbose", "-v", "", "false"));
+    EXPECT_TRUE(parser->flag(&x, "--extract", "-x", "", "false"));
+    EXPECT_TRUE(parser->flag(&threads, "--threads", "-T", "", "1"));
+    EXPECT_TRUE(parser->flag("--file", "-f", "", "none"));
+    parser->command("run", "");
+
+    const char *switches[] = {"./argtest", "-vx"};
+    EXPECT_TRUE(parser->parse(2, switches));
+    EXPECT_TRUE(v);
+    EXPECT_TRUE(x);
+
+    const char *attached[] = {"./argtest", "-T8"};
+    EXPECT_TRUE(parser->parse(2, attached));
+    EXPECT_EQ(threads, 8);
+    EXPECT_FALSE(v);
+
+    const char *detached[] = {"./argtest", "-vT", "4", "-xf", "a.txt"};
+    EXPECT_TRUE(parser->parse(5, detached));
+    EXPECT_TRUE(v);
+    EXPECT_TRUE(x);
+    EXPECT_EQ(threads, 4);
+    EXPECT_EQ(parser->store().get("-f").to<std::string>(), "a.txt");
+
+    // the value is taken from within, so the next argv is a command
+    const char *command[] = {"./argtest", "-vT16", "run"};
+    EXPECT_TRUE(parser->parse(3, command));
+    EXPECT_EQ(threads, 16);
+    EXPECT_EQ(parser->command_path(), std::vector<std::string>{"run"});
+
+    const char *unknown[] = {"./argtest", "-vq"};
+    EXPECT_FALSE(parser->parse(2, unknown));
+    const char *twice[] = {"./argtest", "-vv"};
+    EXPECT_FALSE(parser->parse(2, twice));
+    const char *extra[] = {"./argtest", "-T8=9"};
+    EXPECT_FALSE(parser->parse(2, extra));
+}
+
+TEST(ArgparserFlag, ShortNameShouldWinOverBundle)
+{
+    bool v = false;
+    bool x = false;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag(&v, "--verbose", "-v", "", "false"));
+    EXPECT_TRUE(parser->flag(&x, "--extract", "-x", "", "false"));
+    EXPECT_TRUE(parser->flag("--vx", "-vx", "", "none"));
+    const char *arg[] = {"./argtest", "-vx", "y"};
+    EXPECT_TRUE(parser->parse(3, arg));
+    EXPECT_FALSE(v);
+    EXPECT_FALSE(x);
+    EXPECT_EQ(parser->store().get("-vx").to<std::string>(), "y");
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,149 @@
+#include <inttypes.h>
+
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+namespace
+{
+size_t nr_global_new = 0;
+}  // namespace
+
+void *operator new(std::size_t size)
+{
+    nr_global_new++;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+// std::pmr::new_delete_resource() allocates with the aligned form
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    nr_global_new++;
+    size_t alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) / alignment * alignment;
+    if (void *ptr = std::aligned_alloc(alignment, size == 0 ? alignment : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST(ArgparserPmr, ParseWithoutGlobalNew)
+{
+    int64_t threads;
+    std::string name;
+    bool verbose;
+    double ratio;
+
+    alignas(std::max_align_t) static char buffer[64 * 1024];
+    // running out of the buffer throws rather than falls back to new
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    size_t before_register = nr_global_new;
+    auto parser = argparser::new_parser("a program", &arena);
+    bool succ = parser->flag(&threads, "--threads", "-t", "worker threads");
+    succ &= parser->flag(&name, "--name", "-n", "the name", "anonymous");
+    succ &= parser->global_flag(&verbose, "--verbose", "-v", "be loud", "0");
+    succ &= parser->flag("--config", "-c", "path to config", "/etc/app.conf");
+    auto &start = parser->command("start", "start the service");
+    succ &= start.flag(&ratio, "--ratio", "-r", "a ratio", "0.5");
+    succ &= start.flag("--at", "", "when to start");
+    size_t nr_register = nr_global_new - before_register;
+
+    const char *arg[] = {
+        "./argtest", "-t", "8", "--name=job", "start", "--at", "9", "-v"};
+    size_t before_parse = nr_global_new;
+    succ &= parser->parse(sizeof(arg) / sizeof(arg[0]), arg);
+    size_t nr_parse = nr_global_new - before_parse;
+
+    EXPECT_TRUE(succ);
+    EXPECT_EQ(nr_register, 0);
+    EXPECT_EQ(nr_parse, 0);
+    EXPECT_EQ(threads, 8);
+    EXPECT_EQ(name, "job");
+    EXPECT_TRUE(verbose);
+    EXPECT_EQ(ratio, 0.5);
+    EXPECT_EQ(parser->store().get("--at").inner(), "9");
+}
+
+TEST(ArgparserPmr, ParseAgainWithoutGlobalNew)
+{
+    int64_t threads;
+    alignas(std::max_align_t) static char buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    auto parser = argparser::new_parser("", &arena);
+    EXPECT_TRUE(parser->flag(&threads, "--threads", "-t", "", "1"));
+
+    size_t before = nr_global_new;
+    bool succ = true;
+    for (int i = 0; i < 16; ++i)
+    {
+        const char *arg[] = {"./argtest", "-t", "4"};
+        succ &= parser->parse(sizeof(arg) / sizeof(arg[0]), arg);
+    }
+    size_t nr_parse = nr_global_new - before;
+    EXPECT_TRUE(succ);
+    EXPECT_EQ(nr_parse, 0);
+    EXPECT_EQ(threads, 4);
+}
+
+TEST(ArgparserPmr, LongValuesWithoutGlobalNew)
+{
+    int64_t limit;
+    double ratio;
+    alignas(std::max_align_t) static char buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    // longer than the small string buffer of std::string
+    size_t before_register = nr_global_new;
+    auto parser = argparser::new_parser("", &arena);
+    bool succ =
+        parser->flag(&limit, "--limit", "-l", "", "1000000000000000000");
+    succ &= parser->flag(&ratio, "--ratio", "-r", "", "0.125000000000000000");
+    size_t nr_register = nr_global_new - before_register;
+
+    const char *arg[] = {"./argtest", "--limit=9223372036854775807"};
+    size_t before_parse = nr_global_new;
+    succ &= parser->parse(sizeof(arg) / sizeof(arg[0]), arg);
+    size_t nr_parse = nr_global_new - before_parse;
+
+    EXPECT_TRUE(succ);
+    EXPECT_EQ(nr_register, 0);
+    EXPECT_EQ(nr_parse, 0);
+    EXPECT_EQ(limit, 9223372036854775807);
+    EXPECT_EQ(ratio, 0.125);
+}
+
+TEST(ArgparserPmr, DefaultResourceUsesGlobalNew)
+{
+    size_t before = nr_global_new;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flag("--config", "-c", ""));
+    EXPECT_GT(nr_global_new - before, 0);
+}
@@ -0,0 +1,139 @@
+#include <string>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+ARGPARSER_DECLARE_FLAG(int, threads);
+ARGPARSER_DECLARE_FLAG(std::string, file);
+ARGPARSER_DEFINE_FLAG(bool, verbose, "--verbose", "", "be verbose", "false");
+
+TEST(ArgparserRegistry, ShouldCollectAllUnits)
+{
+    EXPECT_EQ(argparser::registry::nr_flags(), 3);
+}
+
+TEST(ArgparserRegistry, ShouldParseRegisteredFlags)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->load_registered_flags());
+
+    const char *arg[] = {
+        "./argtest", "-t", "8", "--file", "a.txt", "--verbose"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(FLAGS_threads, 8);
+    EXPECT_EQ(FLAGS_file, "a.txt");
+    EXPECT_TRUE(FLAGS_verbose);
+
+    // the flags not given again go back to their defaults
+    const char *arg2[] = {"./argtest", "-f", "b.txt"};
+    EXPECT_TRUE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(FLAGS_threads, 4);
+    EXPECT_EQ(FLAGS_file, "b.txt");
+    EXPECT_FALSE(FLAGS_verbose);
+
+    auto help = parser->help();
+    EXPECT_NE(help.find("--threads"), std::string::npos);
+    EXPECT_NE(help.find("the input file"), std::string::npos);
+}
+
+TEST(ArgparserRegistry, ShouldFailOnMissingOrBadFlags)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->load_registered_flags());
+
+    const char *arg[] = {"./argtest", "-t", "8"};
+    EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    const char *arg2[] = {"./argtest", "-t", "many", "-f", "a"};
+    EXPECT_FALSE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+}
+
+TEST(ArgparserRegistry, ShouldRejectConflicts)
+{
+    int threads;
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->load_registered_flags());
+    EXPECT_FALSE(parser->load_registered_flags());
+    EXPECT_FALSE(parser->flag(&threads, "--threads", "", ""));
+    EXPECT_FALSE(parser->flag(&threads, "--jobs", "-t", ""));
+
+    auto other = argparser::new_parser();
+    EXPECT_TRUE(other->global_flag(&threads, "--threads", "", ""));
+    EXPECT_FALSE(other->load_registered_flags());
+}
+
+TEST(ArgparserRegistry, ShouldParseWhenFrozen)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->load_registered_flags());
+    auto frozen = parser->freeze();
+
+    const char *arg[] = {"./argtest", "--threads", "2", "-f", "c.txt"};
+    argparser::ParseResult result;
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg, result));
+    EXPECT_EQ(result.get("-t").to<int>(), 2);
+    EXPECT_FALSE(result.get("--verbose").to<bool>());
+
+    EXPECT_TRUE(frozen.parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(FLAGS_threads, 2);
+    EXPECT_EQ(FLAGS_file, "c.txt");
+
+    const char *arg2[] = {"./argtest", "-t", "x", "-f", "c.txt"};
+    EXPECT_FALSE(frozen.parse(sizeof(arg2) / sizeof(arg2[0]), arg2, result));
+}
+
+TEST(ArgparserRegistry, ShouldRegisterInBulk)
+{
+    using argparser::registry::describe;
+    int jobs = 0;
+    std::string name;
+    double ratio = 0;
+    const argparser::registry::FlagDescriptor table[] = {
+        describe(&jobs, "--jobs", "-j", "jobs", "2"),
+        describe(&name, "--name", "", "name", nullptr),
+        describe(&ratio, "", "-r", "ratio", "0.5"),
+    };
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->flags(table));
+    EXPECT_FALSE(parser->flag(&jobs, "--other", "-j", ""));
+
+    const char *arg[] = {"./argtest", "--name", "x", "-j", "3"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(jobs, 3);
+    EXPECT_EQ(name, "x");
+    EXPECT_EQ(ratio, 0.5);
+    const char *arg2[] = {"./argtest", "-j", "3"};
+    EXPECT_FALSE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+}
+
+TEST(ArgparserRegistry, ShouldRegisterAllOrNone)
+{
+    using argparser::registry::describe;
+    int a = 0;
+    int b = 0;
+    const argparser::registry::FlagDescriptor duplicated[] = {
+        describe(&a, "--a", "-a", "", "1"),
+        describe(&b, "--b", "-a", "", "1"),
+    };
+    const argparser::registry::FlagDescriptor bad_default[] = {
+        describe(&a, "--a", "-a", "", "1"),
+        describe(&b, "--b", "-b", "", "one"),
+    };
+    const argparser::registry::FlagDescriptor bad_name[] = {
+        describe(&a, "a", "", "", "1"),
+    };
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->global_flag(&b, "--global", "-g", "", "0"));
+    const argparser::registry::FlagDescriptor global[] = {
+        describe(&a, "--a", "-g", "", "1"),
+    };
+    EXPECT_FALSE(parser->flags(duplicated));
+    EXPECT_FALSE(parser->flags(bad_default));
+    EXPECT_FALSE(parser->flags(bad_name));
+    EXPECT_FALSE(parser->flags(global));
+
+    // nothing of the failed batches is registered
+    const char *arg[] = {"./argtest", "--a", "1"};
+    EXPECT_FALSE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_TRUE(parser->flags(bad_default, 1));
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+}
@@ -0,0 +1,8 @@
+#include <string>
+
+#include "argparser/argparser.hpp"
+
+// defined in another translation unit than the tests, on purpose
+ARGPARSER_DEFINE_FLAG(int, threads, "--threads", "-t", "worker threads", "4");
+ARGPARSER_DEFINE_REQUIRED_FLAG(
+    std::string, file, "--file", "-f", "the input file");
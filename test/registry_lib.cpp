@@ -0,0 +1,7 @@
+#include <string>
+
+#include "argparser/argparser.hpp"
+
+// built into a shared library, whose flags join those of the executable
+ARGPARSER_DEFINE_FLAG(int, lib_threads, "--lib-threads", "", "threads", "2");
+ARGPARSER_DEFINE_FLAG(std::string, lib_name, "--lib-name", "-n", "", "lib");
@@ -0,0 +1,31 @@
+#include <string>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+ARGPARSER_DECLARE_FLAG(int, lib_threads);
+ARGPARSER_DECLARE_FLAG(std::string, lib_name);
+ARGPARSER_DEFINE_FLAG(bool, verbose, "--verbose", "-v", "be verbose", "false");
+
+TEST(ArgparserRegistry, ShouldCollectSharedLibraries)
+{
+    EXPECT_EQ(argparser::registry::nr_flags(), 3);
+}
+
+TEST(ArgparserRegistry, ShouldParseFlagsOfSharedLibraries)
+{
+    auto parser = argparser::new_parser();
+    EXPECT_TRUE(parser->load_registered_flags());
+
+    const char *arg[] = {"./argtest", "--lib-threads", "8", "-v"};
+    EXPECT_TRUE(parser->parse(sizeof(arg) / sizeof(arg[0]), arg));
+    EXPECT_EQ(FLAGS_lib_threads, 8);
+    EXPECT_EQ(FLAGS_lib_name, "lib");
+    EXPECT_TRUE(FLAGS_verbose);
+
+    const char *arg2[] = {"./argtest", "-n", "x"};
+    EXPECT_TRUE(parser->parse(sizeof(arg2) / sizeof(arg2[0]), arg2));
+    EXPECT_EQ(FLAGS_lib_threads, 2);
+    EXPECT_EQ(FLAGS_lib_name, "x");
+    EXPECT_FALSE(FLAGS_verbose);
+}
@@ -0,0 +1,86 @@
+#include <string>
+#include <vector>
+
+#include "argparser/argparser.hpp"
+#include "gtest/gtest.h"
+
+namespace schema = argparser::schema;
+
+constexpr auto kSchema =
+    schema::make(schema::flag<int>("--threads", "-t", "threads", "4"),
+                 schema::required<std::string>("--file", "-f", "the file"),
+                 schema::flag<bool>("--verbose", "", "be verbose", "false"),
+                 schema::flag<std::vector<int>>("", "-l", "a list", "1,2"));
+
+// the lookups are resolved at compile time
+static_assert(kSchema.find("--threads") == 0);
+static_assert(kSchema.find("-t") == 0);
+static_assert(kSchema.find("-f") == 1);
+static_assert(kSchema.find("--verbose") == 2);
+static_assert(kSchema.find("-l") == 3);
+static_assert(kSchema.find("--thread") == kSchema.kFlagNr);
+static_assert(kSchema.find("") == kSchema.kFlagNr);
+
+TEST(ArgparserSchema, ShouldParse)
+{
+    int threads;
+    std::string file;
+    bool verbose;
+    std::vector<int> list;
+    const char *arg[] = {
+        "./argtest", "-t", "8", "--file=a.txt", "--verbose", "-l", "3"};
+    EXPECT_TRUE(kSchema.parse(
+        sizeof(arg) / sizeof(arg[0]), arg, &threads, &file, &verbose, &list));
+    EXPECT_EQ(threads, 8);
+    EXPECT_EQ(file, "a.txt");
+    EXPECT_TRUE(verbose);
+    EXPECT_EQ(list, std::vector<int>({3}));
+
+    const char *arg2[] = {"./argtest", "-f", "b.txt"};
+    EXPECT_TRUE(kSchema.parse(sizeof(arg2) / sizeof(arg2[0]),
+                              arg2,
+                              &threads,
+                              &file,
+                              &verbose,
+                              &list));
+    EXPECT_EQ(threads, 4);
+    EXPECT_EQ(file, "b.txt");
+    EXPECT_FALSE(verbose);
+    EXPECT_EQ(list, std::vector<int>({1, 2}));
+}
+
+TEST(ArgparserSchema, ShouldFailOnBadInput)
+{
+    int threads;
+    std::string file;
+    bool verbose;
+    std::vector<int> list;
+    auto parse = [&](std::vector<const char *> arg) {
+        return kSchema.parse(
+            arg.size(), arg.data(), &threads, &file, &verbose, &list);
+    };
+    EXPECT_FALSE(parse({"./argtest", "-t", "8"}));
+    EXPECT_FALSE(parse({"./argtest", "-f", "a", "-t", "x"}));
+    EXPECT_FALSE(parse({"./argtest", "-f", "a", "--unknown", "1"}));
+    EXPECT_FALSE(parse({"./argtest", "-f", "a", "-t", "1", "--threads", "2"}));
+    EXPECT_TRUE(parse({"./argtest", "-f", "a"}));
+}
+
+TEST(ArgparserSchema, ShouldHashManyNames)
+{
+    constexpr auto many = schema::make(schema::flag<int>("--a", "-a", "", "0"),
+                                       schema::flag<int>("--b", "-b", "", "0"),
+                                       schema::flag<int>("--c", "-c", "", "0"),
+                                       schema::flag<int>("--d", "-d", "", "0"),
+                                       schema::flag<int>("--e", "-e", "", "0"),
+                                       schema::flag<int>("--f", "-f", "", "0"),
+                                       schema::flag<int>("--g", "-g", "", "0"),
+                                       schema::flag<int>("--h", "-h", "", "0"));
+    const char *names[] = {"--a", "--b", "--c", "--d", "--e", "--f", "--g",
+                           "--h", "-a",  "-b",  "-c",  "-d",  "-e",  "-f",
+                           "-g",  "-h"};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(many.find(names[i]), i % 8);
+    }
+}